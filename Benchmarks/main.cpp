@@ -0,0 +1,305 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <thread>
+
+#include "GraphLibrary/CSRGraph.h"
+#include "GraphLibrary/GraphIO.h"
+#include "GraphLibrary/BreadthFirstSearch.h"
+
+#include "GroupTheoryLibrary/Permutation.h"
+#include "GroupTheoryLibrary/PermGroup.h"
+#include "GroupTheoryLibrary/LuksIsomorphism.h"
+
+#include "RandomNumberEngine/RandomNumberEngine.h"
+
+using std::cout;
+using std::endl;
+
+using std::string;
+using std::vector;
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static long long file_bytes(const string& path)
+{
+	FILE* f = fopen(path.c_str(), "rb");
+
+	if (!f)
+	{
+		return 0;
+	}
+
+	fseek(f, 0, SEEK_END);
+	long long size = ftell(f);
+	fclose(f);
+
+	return size;
+}
+
+static void io_round_trip(const string& format, const CSRGraph& G, const string& path, std::function<void()> write, std::function<CSRGraph()> read) //times one write and one read of G, checking that the graph survives
+{
+	auto start = std::chrono::steady_clock::now();
+	write();
+	double write_time = seconds_since(start);
+
+	double mb = file_bytes(path) / 1e6;
+
+	start = std::chrono::steady_clock::now();
+	CSRGraph H = read();
+	double read_time = seconds_since(start);
+
+	bool same = H.offset_array() == G.offset_array() && H.neighbor_array() == G.neighbor_array();
+
+	cout << format << ": " << mb << " MB, write " << mb / write_time << " MB/s, read " << mb / read_time << " MB/s" << (same ? "" : ", ROUND TRIP FAILED") << endl;
+
+	std::remove(path.c_str());
+}
+
+static void io_benchmark(const string& dir) //throughput of every reader and writer; graph6 stores n^2/2 bits, so it gets a smaller, denser graph
+{
+	CSRGraph sparse = CSRGraph::gnp_random(1000000, 10.0 / 1000000, 1);
+	CSRGraph dense = CSRGraph::gnp_random(20000, 0.05, 2);
+
+	cout << "sparse: n = " << sparse.size() << ", m = " << sparse.edges() << "; dense: n = " << dense.size() << ", m = " << dense.edges() << endl;
+
+	string path = dir + "/benchmark_graph";
+
+	io_round_trip("edge list", sparse, path, [&]() { write_edge_list(sparse, path); }, [&]() { return read_edge_list(path); });
+	io_round_trip("DIMACS", sparse, path, [&]() { write_dimacs(sparse, path); }, [&]() { return read_dimacs(path); });
+	io_round_trip("sparse6", sparse, path, [&]() { write_sparse6(sparse, path); }, [&]() { return read_graph6(path)[0]; });
+	io_round_trip("graph6", dense, path, [&]() { write_graph6(dense, path); }, [&]() { return read_graph6(path)[0]; });
+}
+
+static bool is_isomorphism(const Graph& G, const Graph& H, const Permutation& pi)
+{
+	for (int v = 0; v < G.size(); v++)
+	{
+		for (int j : G.adj_list()[v])
+		{
+			if (!H.has_edge(pi[v], pi[j]))
+			{
+				return false;
+			}
+		}
+	}
+
+	return G.edges() == H.edges();
+}
+
+static void luks_benchmark() //edge_automorphism_group, the Luks search itself, then bounded_degree_isomorphism against a relabeled copy and against another random graph of the same degree
+{
+	RandomNumberEngine rand_eng(1);
+
+	for (int d : { 3, 4 })
+	{
+		for (int n : { 50, 100, 200, 400, 1000, 2000 })
+		{
+			const int trials = n <= 400 ? 5 : 2; //Aut_e alone takes seconds from n = 1000 on
+
+			double aut_time = 0;
+			double iso_time = 0;
+			double non_iso_time = 0;
+			int failures = 0;
+
+			for (int t = 0; t < trials; t++)
+			{
+				Graph G = CSRGraph::random_regular(n, d, 1000 * n + 2 * t).to_graph();
+				Graph H = Permutation::rand_perm(n, rand_eng)[G];
+				Graph K = CSRGraph::random_regular(n, d, 1000 * n + 2 * t + 1).to_graph();
+
+				auto start = std::chrono::steady_clock::now();
+				PermGroup A = edge_automorphism_group(G, { 0, *G.adj_list()[0].begin() });
+				aut_time += seconds_since(start);
+
+				start = std::chrono::steady_clock::now();
+				IsomorphismResult same = bounded_degree_isomorphism(G, H);
+				iso_time += seconds_since(start);
+
+				start = std::chrono::steady_clock::now();
+				IsomorphismResult different = bounded_degree_isomorphism(G, K);
+				non_iso_time += seconds_since(start);
+
+				if (!same.isomorphic || !is_isomorphism(G, H, same.isomorphism) || different.isomorphic)
+				{
+					failures++;
+				}
+			}
+
+			cout << d << "-regular, n = " << n << ": Aut_e " << aut_time / trials << " s, isomorphic pair " << iso_time / trials << " s, random pair " << non_iso_time / trials << " s" << (failures ? ", WRONG ANSWERS" : "") << endl;
+		}
+	}
+}
+
+static PermGroup symmetric_group(int m) //generated by (0 1) and (0 1 ... m-1)
+{
+	vector<int> transposition(m);
+	vector<int> cycle(m);
+
+	for (int i = 0; i < m; i++)
+	{
+		transposition[i] = i;
+		cycle[i] = (i + 1) % m;
+	}
+
+	std::swap(transposition[0], transposition[1]);
+
+	return PermGroup({ Permutation(transposition), Permutation(cycle) });
+}
+
+static double log10_order(PermGroup& G)
+{
+	double out = 0;
+
+	for (unsigned long long int factor : G.order_factors())
+	{
+		out += std::log10((double)factor);
+	}
+
+	return out;
+}
+
+static void intersect_benchmark() //S_m wr S_k against its conjugates by a transposition across two blocks and by a random permutation; the intersections are large and small respectively
+{
+	RandomNumberEngine rand_eng(1);
+
+	for (std::pair<int, int> sizes : { std::make_pair(5, 10), std::make_pair(10, 10), std::make_pair(10, 20), std::make_pair(10, 40) })
+	{
+		PermGroup G = wreath_product(symmetric_group(sizes.first), symmetric_group(sizes.second));
+		int n = G.degree();
+
+		vector<int> swapped(n);
+
+		for (int i = 0; i < n; i++)
+		{
+			swapped[i] = i;
+		}
+
+		std::swap(swapped[sizes.first - 1], swapped[sizes.first]); //last point of block 0, first point of block 1
+
+		cout << "S" << sizes.first << " wr S" << sizes.second << ", degree " << n << ", log10 |G| = " << log10_order(G) << endl;
+
+		vector<std::pair<string, Permutation>> conjugators = { { "transposition", Permutation(swapped) }, { "random", Permutation::rand_perm(n, rand_eng) } };
+
+		for (const std::pair<string, Permutation>& pi : conjugators)
+		{
+			PermGroup H = G.conjugate(pi.second);
+
+			auto start = std::chrono::steady_clock::now();
+			PermGroup K = intersect(G, H);
+			double time = seconds_since(start);
+
+			bool inside = true;
+
+			for (const Permutation& g : K.get_generators())
+			{
+				inside = inside && G.contains(g) && H.contains(g);
+			}
+
+			cout << "  " << pi.first << " conjugate: " << time << " s, log10 |intersection| = " << log10_order(K) << (inside ? "" : ", WRONG GENERATORS") << endl;
+		}
+	}
+}
+
+static void bfs_benchmark() //BreadthFirstSearch on 10^7 edges as the thread count doubles, against a plain queue
+{
+	const int n = 1000000;
+
+	CSRGraph G = CSRGraph::gnp_random(n, 20.0 / n, 1);
+
+	auto start = std::chrono::steady_clock::now();
+
+	vector<int> distance(n, -1);
+	vector<int> queue = { 0 };
+
+	distance[0] = 0;
+
+	for (int k = 0; k < queue.size(); k++)
+	{
+		for (const int* j = G.begin(queue[k]); j != G.end(queue[k]); j++)
+		{
+			if (distance[*j] == -1)
+			{
+				distance[*j] = distance[queue[k]] + 1;
+				queue.push_back(*j);
+			}
+		}
+	}
+
+	cout << "BFS, " << G.edges() << " edges: queue " << seconds_since(start) << " s" << endl;
+
+	int max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+	for (int threads = 1; threads <= max_threads; threads *= 2)
+	{
+		start = std::chrono::steady_clock::now();
+		BreadthFirstSearch bfs(G, 0, threads);
+		double time = seconds_since(start);
+
+		cout << "BFS, " << threads << " threads: " << time << " s, " << bfs.levels() << " levels, " << bfs.bottom_up_levels() << " bottom-up" << (bfs.distance_array() != distance ? ", WRONG DISTANCES" : "") << endl;
+	}
+}
+
+static void construction_benchmark() //Graph from 10^7 random pairs in one batch, then a tenth of them deleted and inserted again, in batches and one at a time
+{
+	const int n = 1000000;
+	const int m = 10000000;
+
+	RandomNumberEngine rand_eng(1);
+
+	vector<std::pair<int, int>> edge_list(m);
+
+	for (auto& e : edge_list)
+	{
+		e = { rand_eng.random_int(0, n - 1), rand_eng.random_int(0, n - 1) };
+	}
+
+	vector<std::pair<int, int>> batch(edge_list.begin(), edge_list.begin() + m / 10);
+
+	auto start = std::chrono::steady_clock::now();
+	Graph G(n, edge_list);
+	cout << "Graph from " << m << " pairs: " << seconds_since(start) << " s, " << G.edges() << " edges" << endl;
+
+	start = std::chrono::steady_clock::now();
+	G.delete_edges(batch);
+	double delete_time = seconds_since(start);
+
+	start = std::chrono::steady_clock::now();
+	G.insert_edges(batch);
+	cout << batch.size() << " pairs: delete_edges " << delete_time << " s, insert_edges " << seconds_since(start) << " s" << endl;
+
+	start = std::chrono::steady_clock::now();
+
+	for (auto e : batch)
+	{
+		G.delete_edge(e.first, e.second);
+	}
+
+	delete_time = seconds_since(start);
+	start = std::chrono::steady_clock::now();
+
+	for (auto e : batch)
+	{
+		G.insert_edge(e.first, e.second);
+	}
+
+	cout << batch.size() << " pairs: delete_edge " << delete_time << " s, insert_edge " << seconds_since(start) << " s" << endl;
+}
+
+int main(int argc, char** argv)
+{
+	string dir = argc > 1 ? argv[1] : "."; //where the scratch files go
+
+	io_benchmark(dir);
+	construction_benchmark();
+	bfs_benchmark();
+	luks_benchmark();
+	intersect_benchmark();
+}
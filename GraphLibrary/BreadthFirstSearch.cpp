@@ -0,0 +1,268 @@
+#include "BreadthFirstSearch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+using std::vector;
+
+static const int alpha = 14; //go bottom-up once a growing frontier holds more than 1/alpha of the edges of unreached vertices
+static const int beta = 24; //go back top-down once the frontier shrinks below n/beta vertices
+static const long long parallel_work = 1 << 16; //edges and words to scan below which a level is expanded in the calling thread
+
+static const int vertex_block = 1024; //top-down work unit, in frontier vertices
+static const int word_block = 64; //bottom-up work unit, in bitmap words
+
+template<class F>
+static void parallel_blocks(int count, int block, int threads, F f) //calls f(k, first, last) on each block k = [first, last) of [0, count) from a pool of threads
+{
+	const int num_blocks = (count + block - 1) / block;
+
+	std::atomic<int> next_block(0);
+
+	auto worker = [&]()
+	{
+		for (int k = next_block++; k < num_blocks; k = next_block++)
+		{
+			f(k, k * block, std::min(count, (k + 1) * block));
+		}
+	};
+
+	vector<std::thread> pool;
+
+	for (int t = 1; t < std::min(threads, num_blocks); t++)
+	{
+		pool.emplace_back(worker);
+	}
+
+	worker();
+
+	for (auto& t : pool)
+	{
+		t.join();
+	}
+}
+
+static bool test(const vector<std::atomic<uint64_t>>& bitmap, int v)
+{
+	return (bitmap[v >> 6].load(std::memory_order_relaxed) >> (v & 63)) & 1;
+}
+
+BreadthFirstSearch::BreadthFirstSearch(const CSRGraph& G, int source, int threads)
+{
+	search(G, { source }, threads);
+}
+
+BreadthFirstSearch::BreadthFirstSearch(const CSRGraph& G, const std::vector<int>& sources, int threads)
+{
+	search(G, sources, threads);
+}
+
+void BreadthFirstSearch::search(const CSRGraph& G, const std::vector<int>& sources, int threads)
+{
+	if (threads <= 0)
+	{
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	int n = G.size();
+	int words = (n + 63) / 64;
+
+	const int* slots = G.neighbor_array().data();
+
+	distances.assign(n, -1);
+	parents.assign(n, -1);
+	parent_slots.assign(n, -1);
+
+	order.clear();
+	level_offsets.assign(1, 0);
+	bottom_up = 0;
+
+	vector<std::atomic<uint64_t>> visited(words); //value-initialized, so all zero
+	vector<std::atomic<uint64_t>> frontier(words); //bottom-up only: the current level, then the next one
+	vector<std::atomic<uint64_t>> next(words);
+
+	long long unexplored = G.neighbor_array().size(); //degrees of unreached vertices
+	long long frontier_edges = 0; //degrees of the current level
+
+	for (int s : sources)
+	{
+		if (s >= 0 && s < n && distances[s] == -1)
+		{
+			distances[s] = 0;
+			visited[s >> 6].fetch_or(1ULL << (s & 63), std::memory_order_relaxed);
+			order.push_back(s);
+			frontier_edges += G.degree(s);
+		}
+	}
+
+	if (order.empty())
+	{
+		return;
+	}
+
+	std::sort(order.begin(), order.end());
+	level_offsets.push_back(order.size());
+	unexplored -= frontier_edges;
+
+	vector<vector<int>> found; //vertices of the next level, per block of work
+	vector<long long> found_edges;
+
+	bool top_down = true;
+	int previous_size = 0;
+
+	for (int d = 0; unexplored > 0; d++) //once no unreached vertex has an edge, no level follows
+	{
+		int size = level_size(d);
+
+		if (top_down && frontier_edges > unexplored / alpha && size > previous_size)
+		{
+			top_down = false;
+
+			const int* level = begin(d);
+
+			parallel_blocks(words, word_block, threads, [&](int, int first, int last) //stale from an earlier bottom-up stretch
+			{
+				for (int w = first; w < last; w++)
+				{
+					frontier[w].store(0, std::memory_order_relaxed);
+				}
+			});
+
+			parallel_blocks(size, vertex_block, threads, [&](int, int first, int last)
+			{
+				for (int i = first; i < last; i++)
+				{
+					frontier[level[i] >> 6].fetch_or(1ULL << (level[i] & 63), std::memory_order_relaxed);
+				}
+			});
+		}
+
+		else if (!top_down && size < n / beta && size < previous_size)
+		{
+			top_down = true;
+		}
+
+		int num_blocks = top_down ? (size + vertex_block - 1) / vertex_block : (words + word_block - 1) / word_block;
+
+		if (found.size() < num_blocks)
+		{
+			found.resize(num_blocks);
+			found_edges.resize(num_blocks);
+		}
+
+		if (top_down) //a vertex belongs to whichever thread sets its visited bit first
+		{
+			const int* level = begin(d);
+
+			parallel_blocks(size, vertex_block, frontier_edges < parallel_work ? 1 : threads, [&](int k, int first, int last)
+			{
+				found[k].clear();
+				found_edges[k] = 0;
+
+				for (int i = first; i < last; i++)
+				{
+					int u = level[i];
+
+					for (const int* j = G.begin(u); j != G.end(u); j++)
+					{
+						int v = *j;
+						uint64_t bit = 1ULL << (v & 63);
+
+						if ((visited[v >> 6].load(std::memory_order_relaxed) & bit) || (visited[v >> 6].fetch_or(bit, std::memory_order_relaxed) & bit))
+						{
+							continue;
+						}
+
+						distances[v] = d + 1;
+						parents[v] = u;
+						parent_slots[v] = std::lower_bound(G.begin(v), G.end(v), u) - slots;
+
+						found[k].push_back(v);
+						found_edges[k] += G.degree(v);
+					}
+				}
+			});
+		}
+
+		else //each block of words belongs to one thread, so the bitmaps are written without read-modify-write
+		{
+			bottom_up++;
+
+			parallel_blocks(words, word_block, words + unexplored < parallel_work ? 1 : threads, [&](int k, int first, int last)
+			{
+				found[k].clear();
+				found_edges[k] = 0;
+
+				for (int w = first; w < last; w++)
+				{
+					uint64_t unreached = ~visited[w].load(std::memory_order_relaxed);
+					uint64_t reached_now = 0;
+
+					if (w == words - 1 && (n & 63) != 0)
+					{
+						unreached &= (1ULL << (n & 63)) - 1;
+					}
+
+					for (int b = 0; b < 64 && (unreached >> b) != 0; b++)
+					{
+						if (((unreached >> b) & 1) == 0)
+						{
+							continue;
+						}
+
+						int v = 64 * w + b;
+
+						for (const int* j = G.begin(v); j != G.end(v); j++)
+						{
+							if (test(frontier, *j))
+							{
+								distances[v] = d + 1;
+								parents[v] = *j;
+								parent_slots[v] = j - slots;
+
+								reached_now |= 1ULL << b;
+								found[k].push_back(v);
+								found_edges[k] += G.degree(v);
+
+								break;
+							}
+						}
+					}
+
+					next[w].store(reached_now, std::memory_order_relaxed);
+
+					if (reached_now != 0)
+					{
+						visited[w].store(~unreached | reached_now, std::memory_order_relaxed);
+					}
+				}
+			});
+
+			frontier.swap(next);
+		}
+
+		frontier_edges = 0;
+
+		for (int k = 0; k < num_blocks; k++)
+		{
+			order.insert(order.end(), found[k].begin(), found[k].end());
+			frontier_edges += found_edges[k];
+		}
+
+		if (order.size() == level_offsets.back())
+		{
+			break;
+		}
+
+		if (top_down) //bottom-up blocks come out in increasing order already
+		{
+			std::sort(order.begin() + level_offsets.back(), order.end());
+		}
+
+		level_offsets.push_back(order.size());
+		unexplored -= frontier_edges;
+		previous_size = size;
+	}
+}
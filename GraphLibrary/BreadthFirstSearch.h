@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+#include "CSRGraph.h"
+
+//Direction-optimizing BFS (Beamer, Asanovic, Patterson). A level is expanded top-down, from the edges of the frontier, while the frontier is small, and bottom-up,
+//with every unreached vertex scanning its neighbors for one in the frontier, while the frontier holds a large share of the remaining edges. Reached vertices and
+//the bottom-up frontier are bitmaps; each level is expanded by a pool of threads, and levels too small to pay for the threads are expanded in the calling one.
+
+class BreadthFirstSearch
+{
+
+private:
+
+	std::vector<int> order; //reached vertices level by level, each level in increasing order
+	std::vector<int> level_offsets; //level d is order[level_offsets[d]], ... , order[level_offsets[d+1]-1]
+
+	std::vector<int> distances; //-1 if unreached
+	std::vector<int> parents; //-1 for sources and unreached vertices
+	std::vector<int> parent_slots; //index into the neighbor array of the tree edge, in the row of the child; -1 where parents is
+
+	int bottom_up; //number of levels expanded bottom-up
+
+	void search(const CSRGraph& G, const std::vector<int>& sources, int threads);
+
+public:
+
+	BreadthFirstSearch(const CSRGraph& G, int source, int threads = 0); //threads = 0 uses every hardware thread
+	BreadthFirstSearch(const CSRGraph& G, const std::vector<int>& sources, int threads = 0); //all sources at level 0; out of range and repeated sources are skipped
+
+	int levels() const { return level_offsets.size() - 1; }
+	int level_size(int d) const { return level_offsets[d + 1] - level_offsets[d]; }
+
+	const int* begin(int d) const { return order.data() + level_offsets[d]; }
+	const int* end(int d) const { return order.data() + level_offsets[d + 1]; }
+
+	int reached() const { return order.size(); }
+	bool is_reached(int v) const { return distances[v] != -1; }
+
+	const std::vector<int>& vertex_order() const { return order; }
+	const std::vector<int>& distance_array() const { return distances; }
+	const std::vector<int>& parent_array() const { return parents; } //each parent is one level closer to the sources; which one depends on the threads unless threads = 1
+	const std::vector<int>& parent_edge_array() const { return parent_slots; } //G.neighbor_array()[parent_edge_array()[v]] == parent_array()[v]
+
+	int bottom_up_levels() const { return bottom_up; }
+};
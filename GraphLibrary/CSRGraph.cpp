@@ -0,0 +1,608 @@
+#include "CSRGraph.h"
+#include "BreadthFirstSearch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <thread>
+
+#include "RandomNumberEngine/RandomNumberEngine.h"
+
+using std::vector;
+using std::set;
+
+CSRGraph::CSRGraph(const Graph& G) :
+	n(G.size()),
+	offsets(G.size() + 1, 0)
+{
+	const vector<set<int>>& adj = G.adj_list();
+
+	for (int v = 0; v < n; v++)
+	{
+		offsets[v + 1] = offsets[v] + adj[v].size();
+	}
+
+	neighbors.reserve(offsets[n]);
+
+	for (int v = 0; v < n; v++)
+	{
+		neighbors.insert(neighbors.end(), adj[v].begin(), adj[v].end()); //sets are already sorted
+	}
+}
+
+CSRGraph::CSRGraph(int size, const std::vector<std::pair<int, int>>& edge_list) :
+	n(size),
+	offsets(size + 1, 0)
+{
+	for (auto e : edge_list) //count degrees, then place each end with a counting sort
+	{
+		if (e.first >= 0 && e.first < n && e.second >= 0 && e.second < n && e.first != e.second)
+		{
+			offsets[e.first + 1]++;
+			offsets[e.second + 1]++;
+		}
+	}
+
+	for (int v = 0; v < n; v++)
+	{
+		offsets[v + 1] += offsets[v];
+	}
+
+	neighbors.resize(offsets[n]);
+
+	vector<int> next(offsets.begin(), offsets.end() - 1);
+
+	for (auto e : edge_list)
+	{
+		if (e.first >= 0 && e.first < n && e.second >= 0 && e.second < n && e.first != e.second)
+		{
+			neighbors[next[e.first]++] = e.second;
+			neighbors[next[e.second]++] = e.first;
+		}
+	}
+
+	sort_and_deduplicate();
+}
+
+CSRGraph::CSRGraph(std::vector<int>&& offsets, std::vector<int>&& neighbors) :
+	n(offsets.size() - 1),
+	offsets(std::move(offsets)),
+	neighbors(std::move(neighbors))
+{
+}
+
+void CSRGraph::sort_and_deduplicate()
+{
+	int write = 0;
+
+	for (int v = 0; v < n; v++)
+	{
+		int first = offsets[v];
+		int last = offsets[v + 1];
+
+		std::sort(neighbors.begin() + first, neighbors.begin() + last);
+
+		offsets[v] = write;
+
+		for (int k = first; k < last; k++)
+		{
+			if (k == first || neighbors[k] != neighbors[k - 1])
+			{
+				neighbors[write++] = neighbors[k];
+			}
+		}
+	}
+
+	offsets[n] = write;
+	neighbors.resize(write);
+	neighbors.shrink_to_fit();
+}
+
+int CSRGraph::max_degree() const
+{
+	int max = 0;
+
+	for (int v = 0; v < n; v++)
+	{
+		max = std::max(max, degree(v));
+	}
+
+	return max;
+}
+
+bool CSRGraph::has_edge(int i, int j) const
+{
+	if (i < 0 || i >= n)
+	{
+		return false;
+	}
+
+	return std::binary_search(begin(i), end(i), j);
+}
+
+std::set<int> CSRGraph::con_comp(int i, int threads) const
+{
+	if (i < 0 || i >= n)
+	{
+		return {};
+	}
+
+	BreadthFirstSearch bfs(*this, i, threads);
+
+	set<int> out;
+
+	for (int v = 0; v < n; v++)
+	{
+		if (bfs.is_reached(v))
+		{
+			out.insert(out.end(), v);
+		}
+	}
+
+	return out;
+}
+
+std::vector<std::set<int>> CSRGraph::conn_components() const
+{
+	ComponentLabels labels = component_labels();
+
+	vector<vector<int>> members(labels.count());
+
+	for (int c = 0; c < labels.count(); c++)
+	{
+		members[c].reserve(labels.sizes[c]);
+	}
+
+	for (int v = 0; v < n; v++)
+	{
+		members[labels.component[v]].push_back(v); //increasing, so each set is built by appending
+	}
+
+	vector<set<int>> out(labels.count());
+
+	for (int c = 0; c < labels.count(); c++)
+	{
+		out[c].insert(members[c].begin(), members[c].end());
+	}
+
+	return out;
+}
+
+bool CSRGraph::is_connected() const
+{
+	if (n <= 1)
+	{
+		return true;
+	}
+
+	if (edges() < n - 1)
+	{
+		return false;
+	}
+
+	vector<bool> reached(n, false);
+	vector<int> queue = { 0 };
+
+	queue.reserve(n);
+	reached[0] = true;
+
+	for (int k = 0; k < queue.size(); k++)
+	{
+		for (const int* j = begin(queue[k]); j != end(queue[k]); j++)
+		{
+			if (!reached[*j])
+			{
+				reached[*j] = true;
+				queue.push_back(*j);
+
+				if (queue.size() == n)
+				{
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+ComponentLabels CSRGraph::component_labels() const
+{
+	ComponentLabels out;
+
+	out.component.assign(n, -1);
+
+	vector<int> queue;
+	queue.reserve(n);
+
+	for (int start = 0; start < n; start++)
+	{
+		if (out.component[start] != -1)
+		{
+			continue;
+		}
+
+		int c = out.count();
+
+		queue.assign(1, start);
+		out.component[start] = c;
+
+		for (int k = 0; k < queue.size(); k++)
+		{
+			for (const int* j = begin(queue[k]); j != end(queue[k]); j++)
+			{
+				if (out.component[*j] == -1)
+				{
+					out.component[*j] = c;
+					queue.push_back(*j);
+				}
+			}
+		}
+
+		out.sizes.push_back(queue.size());
+	}
+
+	return out;
+}
+
+template<class F>
+static void parallel_chunks(int count, int threads, F f) //calls f(first, last) on blocks of [0, count) from a pool of threads
+{
+	const int chunk = 4096;
+	const int num_chunks = (count + chunk - 1) / chunk;
+
+	std::atomic<int> next_chunk(0);
+
+	auto worker = [&]()
+	{
+		for (int k = next_chunk++; k < num_chunks; k = next_chunk++)
+		{
+			f(k * chunk, std::min(count, (k + 1) * chunk));
+		}
+	};
+
+	vector<std::thread> pool;
+
+	for (int t = 1; t < std::min(threads, num_chunks); t++)
+	{
+		pool.emplace_back(worker);
+	}
+
+	worker();
+
+	for (auto& t : pool)
+	{
+		t.join();
+	}
+}
+
+static void link(vector<std::atomic<int>>& parent, int u, int v) //merges the trees of u and v, always hanging the larger root under the smaller, so each root is the smallest vertex of its tree
+{
+	int p1 = parent[u].load(std::memory_order_relaxed);
+	int p2 = parent[v].load(std::memory_order_relaxed);
+
+	while (p1 != p2)
+	{
+		int high = std::max(p1, p2);
+		int low = std::min(p1, p2);
+		int p_high = parent[high].load(std::memory_order_relaxed);
+
+		if (p_high == low || (p_high == high && parent[high].compare_exchange_strong(p_high, low, std::memory_order_relaxed)))
+		{
+			return;
+		}
+
+		p1 = parent[parent[high].load(std::memory_order_relaxed)].load(std::memory_order_relaxed);
+		p2 = parent[low].load(std::memory_order_relaxed);
+	}
+}
+
+static void compress(vector<std::atomic<int>>& parent, int first, int last)
+{
+	for (int v = first; v < last; v++)
+	{
+		int p = parent[v].load(std::memory_order_relaxed);
+
+		while (p != parent[p].load(std::memory_order_relaxed))
+		{
+			p = parent[p].load(std::memory_order_relaxed);
+		}
+
+		parent[v].store(p, std::memory_order_relaxed);
+	}
+}
+
+ComponentLabels CSRGraph::component_labels_parallel(int threads) const
+{
+	if (threads <= 0)
+	{
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	vector<std::atomic<int>> parent(n);
+
+	parallel_chunks(n, threads, [&](int first, int last)
+	{
+		for (int v = first; v < last; v++)
+		{
+			parent[v].store(v, std::memory_order_relaxed);
+		}
+	});
+
+	const int sample_rounds = 2; //link along the first few neighbors of every vertex; this usually settles the giant component
+
+	for (int r = 0; r < sample_rounds; r++)
+	{
+		parallel_chunks(n, threads, [&](int first, int last)
+		{
+			for (int v = first; v < last; v++)
+			{
+				if (r < degree(v))
+				{
+					link(parent, v, begin(v)[r]);
+				}
+			}
+		});
+
+		parallel_chunks(n, threads, [&](int first, int last) { compress(parent, first, last); });
+	}
+
+	int frequent = -1; //most common root among a sample of vertices; its members need no further work
+
+	if (n > 0)
+	{
+		std::map<int, int> counts;
+		RandomNumberEngine rand_eng(1);
+
+		for (int s = 0; s < 1024; s++)
+		{
+			counts[parent[rand_eng.random_int(0, n - 1)].load(std::memory_order_relaxed)]++;
+		}
+
+		frequent = std::max_element(counts.begin(), counts.end(), [](const std::pair<const int, int>& a, const std::pair<const int, int>& b) { return a.second < b.second; })->first;
+	}
+
+	parallel_chunks(n, threads, [&](int first, int last) //an edge into the frequent component is still seen from its other end, which is outside it
+	{
+		for (int v = first; v < last; v++)
+		{
+			if (parent[v].load(std::memory_order_relaxed) == frequent)
+			{
+				continue;
+			}
+
+			for (const int* j = begin(v) + std::min(sample_rounds, degree(v)); j != end(v); j++)
+			{
+				link(parent, v, *j);
+			}
+		}
+	});
+
+	parallel_chunks(n, threads, [&](int first, int last) { compress(parent, first, last); });
+
+	ComponentLabels out; //roots are the smallest vertices of their components, so numbering them in increasing order matches component_labels
+
+	out.component.resize(n);
+
+	for (int v = 0; v < n; v++)
+	{
+		int root = parent[v].load(std::memory_order_relaxed);
+
+		if (root == v)
+		{
+			out.component[v] = out.count();
+			out.sizes.push_back(0);
+		}
+
+		else
+		{
+			out.component[v] = out.component[root];
+		}
+
+		out.sizes[out.component[v]]++;
+	}
+
+	return out;
+}
+
+Graph CSRGraph::to_graph() const
+{
+	return Graph(*this);
+}
+
+static int stream_seed(int seed, int stream) //splitmix64 finalizer, so neighboring streams are unrelated
+{
+	uint64_t x = (uint64_t)(uint32_t)seed * 0x9E3779B97F4A7C15ULL + (uint64_t)stream + 1;
+
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	x = x ^ (x >> 31);
+
+	return (int)(x % 2147483646) + 1; //minstd_rand wants a seed in [1, 2^31 - 2]
+}
+
+static void gnp_rows(int first_row, int last_row, double p, int seed, std::vector<std::pair<int, int>>& out) //edges (v, w), w < v, for rows v in [first_row, last_row), in row-major order
+{
+	if (p <= 0)
+	{
+		return;
+	}
+
+	if (p >= 1)
+	{
+		for (int v = first_row; v < last_row; v++)
+		{
+			for (int w = 0; w < v; w++)
+			{
+				out.push_back({ v, w });
+			}
+		}
+
+		return;
+	}
+
+	RandomNumberEngine rand_eng(seed);
+
+	double log_q = std::log1p(-p);
+
+	long long v = first_row;
+	long long w = -1;
+
+	while (v < last_row)
+	{
+		double skip = std::floor(std::log1p(-rand_eng.random_double()) / log_q); //number of pairs skipped before the next edge
+
+		if (skip > 4e18) //past every remaining pair
+		{
+			break;
+		}
+
+		w += 1 + (long long)skip;
+
+		while (w >= v && v < last_row) //carry the overflow into the following rows
+		{
+			w -= v;
+			v++;
+		}
+
+		if (v < last_row)
+		{
+			out.push_back({ (int)v, (int)w });
+		}
+	}
+}
+
+CSRGraph CSRGraph::gnp_random(int n, double p, int seed, int threads)
+{
+	const int num_ranges = std::max(1, std::min(n, 256));
+
+	vector<int> row_start(num_ranges + 1); //row v holds v pairs, so equal pair counts need boundaries at n * sqrt(k / num_ranges)
+
+	for (int k = 0; k <= num_ranges; k++)
+	{
+		row_start[k] = (int)std::llround(n * std::sqrt((double)k / num_ranges));
+	}
+
+	row_start[num_ranges] = n;
+
+	vector<vector<std::pair<int, int>>> range_edges(num_ranges);
+
+	if (threads <= 0)
+	{
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	std::atomic<int> next_range(0);
+
+	auto worker = [&]()
+	{
+		for (int k = next_range++; k < num_ranges; k = next_range++)
+		{
+			gnp_rows(row_start[k], row_start[k + 1], p, stream_seed(seed, k), range_edges[k]);
+		}
+	};
+
+	vector<std::thread> pool;
+
+	for (int t = 1; t < std::min(threads, num_ranges); t++)
+	{
+		pool.emplace_back(worker);
+	}
+
+	worker();
+
+	for (auto& t : pool)
+	{
+		t.join();
+	}
+
+	vector<int> offsets(n + 1, 0);
+
+	for (int k = 0; k < num_ranges; k++)
+	{
+		for (auto e : range_edges[k])
+		{
+			offsets[e.first + 1]++;
+			offsets[e.second + 1]++;
+		}
+	}
+
+	for (int v = 0; v < n; v++)
+	{
+		offsets[v + 1] += offsets[v];
+	}
+
+	vector<int> neighbors(offsets[n]);
+	vector<int> next(offsets.begin(), offsets.end() - 1);
+
+	for (int k = 0; k < num_ranges; k++) //in row-major order each list receives its smaller neighbors, then its larger ones, both increasing, so no sort is needed
+	{
+		for (auto e : range_edges[k])
+		{
+			neighbors[next[e.first]++] = e.second;
+			neighbors[next[e.second]++] = e.first;
+		}
+
+		vector<std::pair<int, int>>().swap(range_edges[k]);
+	}
+
+	return CSRGraph(std::move(offsets), std::move(neighbors));
+}
+
+CSRGraph CSRGraph::gnp_random_connected(int n, double p, int seed, int threads, int max_attempts)
+{
+	for (int attempt = 0; attempt < max_attempts; attempt++)
+	{
+		CSRGraph G = gnp_random(n, p, stream_seed(seed, -1 - attempt), threads);
+
+		if (G.is_connected())
+		{
+			return G;
+		}
+	}
+
+	throw GraphGenerationFailed();
+}
+
+CSRGraph CSRGraph::random_regular(int n, int d, int seed, int max_attempts)
+{
+	if (n < 0 || d < 0 || d >= std::max(n, 1) || ((long long)n * d) % 2 != 0)
+	{
+		throw GraphGenerationFailed();
+	}
+
+	vector<int> points((size_t)n * d); //d points per vertex, matched up in random pairs
+	vector<std::pair<int, int>> edge_list;
+
+	for (int attempt = 0; attempt < max_attempts; attempt++)
+	{
+		RandomNumberEngine rand_eng(stream_seed(seed, attempt));
+
+		for (int k = 0; k < points.size(); k++)
+		{
+			points[k] = k / d;
+		}
+
+		for (int k = points.size() - 1; k > 0; k--)
+		{
+			std::swap(points[k], points[rand_eng.random_int(0, k)]);
+		}
+
+		edge_list.clear();
+
+		for (int k = 0; k < points.size(); k += 2)
+		{
+			edge_list.push_back({ points[k], points[k + 1] });
+		}
+
+		CSRGraph G(n, edge_list); //drops loops and repeats, so the pairing was simple exactly when nothing was dropped
+
+		if (G.edges() == edge_list.size())
+		{
+			return G;
+		}
+	}
+
+	throw GraphGenerationFailed();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <set>
+#include <utility>
+#include <exception>
+
+#include "Graph.h"
+
+class CSRGraph //immutable undirected graph in compressed sparse row form: the neighbors of v are neighbors[offsets[v]], ... , neighbors[offsets[v+1]-1], in increasing order
+{
+
+private:
+
+	int n;
+
+	std::vector<int> offsets; //n+1 entries
+	std::vector<int> neighbors; //each edge appears once from each end
+
+	void sort_and_deduplicate(); //sorts each neighbor list and drops repeated entries, compacting the arrays
+
+public:
+
+	CSRGraph(const Graph& G);
+	CSRGraph(int size, const std::vector<std::pair<int, int>>& edge_list); //like inserting each edge into Graph(size): self-loops, repeats and out of range pairs are skipped
+	CSRGraph(std::vector<int>&& offsets, std::vector<int>&& neighbors); //takes arrays already in CSR form, each list sorted and symmetric; used by the builders and readers
+
+	int size() const { return n; } //number of vertices
+	int edges() const { return neighbors.size() / 2; }
+
+	int degree(int v) const { return offsets[v + 1] - offsets[v]; }
+	int max_degree() const;
+
+	const int* begin(int v) const { return neighbors.data() + offsets[v]; }
+	const int* end(int v) const { return neighbors.data() + offsets[v + 1]; }
+
+	const std::vector<int>& offset_array() const { return offsets; }
+	const std::vector<int>& neighbor_array() const { return neighbors; }
+
+	bool has_edge(int i, int j) const; //binary search in the neighbors of i
+
+	std::set<int> con_comp(int i, int threads = 0) const; //vertices connected to i; direction-optimizing BFS, see BreadthFirstSearch.h; threads = 0 uses every hardware thread
+	std::vector<std::set<int>> conn_components() const; //built from component_labels
+	bool is_connected() const; //BFS from 0, stopping once every vertex is reached
+
+	ComponentLabels component_labels() const; //one BFS sweep over all vertices, O(n + m)
+	ComponentLabels component_labels_parallel(int threads = 0) const; //Afforest-style concurrent union-find; same labels as component_labels; threads = 0 uses every hardware thread
+
+	Graph to_graph() const;
+
+	//G(n,p) in O(n + m) expected time: the gaps between edges in the row-major order of pairs are drawn geometrically (Batagelj-Brandes).
+	//The pairs are cut into a fixed number of row ranges, each with its own stream seeded from seed, so the result depends on seed alone, not on threads.
+	static CSRGraph gnp_random(int n, double p, int seed, int threads = 0); //threads = 0 uses every hardware thread
+	static CSRGraph gnp_random_connected(int n, double p, int seed, int threads = 0, int max_attempts = 1000); //G(n,p) conditioned on being connected, by rejection with fresh seeds; throws GraphGenerationFailed after max_attempts
+
+	static CSRGraph random_regular(int n, int d, int seed, int max_attempts = 1000); //uniform d-regular graph by the pairing model, rejecting pairings with loops or repeated edges; meant for small d, since about e^((d^2-1)/4) attempts are needed; throws GraphGenerationFailed if n d is odd, d >= n, or no attempt succeeds
+};
+
+class GraphGenerationFailed : public std::exception
+{
+public:
+
+	virtual char const* what() const throw()
+	{
+		return "No graph with the requested property was generated";
+	}
+};
@@ -0,0 +1,293 @@
+#include "ColorRefinement.h"
+
+#include <algorithm>
+
+using std::vector;
+
+OrderedPartition::OrderedPartition(const std::vector<int>& colors) :
+	order(colors.size()),
+	position(colors.size()),
+	cell_start(colors.size()),
+	cell_stop(colors.size()),
+	num_cells(0)
+{
+	int n = colors.size();
+
+	for (int v = 0; v < n; v++)
+	{
+		order[v] = v;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return colors[a] < colors[b]; });
+
+	for (int k = 0; k < n; k++)
+	{
+		position[order[k]] = k;
+	}
+
+	for (int s = 0; s < n;)
+	{
+		int t = s;
+
+		while (t < n && colors[order[t]] == colors[order[s]])
+		{
+			cell_start[order[t]] = s;
+			t++;
+		}
+
+		cell_stop[s] = t;
+		num_cells++;
+		s = t;
+	}
+}
+
+static vector<int> colors_of(const ColoredSet& colored_set)
+{
+	int outside = 0;
+
+	for (int v : colored_set.set)
+	{
+		outside = std::max(outside, colored_set.colors[v] + 1);
+	}
+
+	vector<int> colors(colored_set.colors.size(), outside);
+
+	for (int v : colored_set.set)
+	{
+		colors[v] = colored_set.colors[v];
+	}
+
+	return colors;
+}
+
+OrderedPartition::OrderedPartition(const ColoredSet& colored_set) :
+	OrderedPartition(colors_of(colored_set))
+{
+}
+
+std::vector<int> OrderedPartition::colors() const
+{
+	return cell_start;
+}
+
+void OrderedPartition::restore(int checkpoint)
+{
+	for (int i = history.size() - 1; i >= checkpoint; i--) //latest first, so each fragment is whole again when it is merged back
+	{
+		int c = history[i].first;
+		int f = history[i].second;
+
+		for (int k = f; k < cell_stop[f]; k++)
+		{
+			cell_start[order[k]] = c;
+		}
+
+		cell_stop[c] = std::max(cell_stop[c], cell_stop[f]); //the fragments of one split come back last to first
+		num_cells--;
+	}
+
+	history.resize(checkpoint);
+}
+
+ColorRefinement::ColorRefinement(const CSRGraph& G) :
+	graph(G),
+	count(G.size(), 0),
+	cell_touched(G.size(), 0),
+	in_worklist(G.size(), false)
+{
+}
+
+void ColorRefinement::push(int c)
+{
+	if (!in_worklist[c])
+	{
+		in_worklist[c] = true;
+		worklist.push_back(c);
+	}
+}
+
+void ColorRefinement::split(OrderedPartition& P, int c)
+{
+	int stop = P.cell_stop[c];
+	int first_touched = stop - cell_touched[c];
+
+	cell_touched[c] = 0;
+
+	vector<int>::iterator tail = P.order.begin() + first_touched;
+
+	bool uniform = std::all_of(tail, P.order.begin() + stop, [&](int w) { return count[w] == count[*tail]; });
+
+	if (first_touched == c && uniform) //every vertex of the cell sees the splitter equally often
+	{
+		return;
+	}
+
+	if (!uniform)
+	{
+		std::sort(tail, P.order.begin() + stop, [&](int a, int b) { return count[a] < count[b]; });
+
+		for (int k = first_touched; k < stop; k++)
+		{
+			P.position[P.order[k]] = k;
+		}
+	}
+
+	fragments.assign(1, c); //starts of the fragments, in order; the first keeps the name c
+
+	for (int k = first_touched; k < stop; k++)
+	{
+		if (k > c && (k == first_touched || count[P.order[k]] != count[P.order[k - 1]]))
+		{
+			fragments.push_back(k);
+		}
+	}
+
+	fragments.push_back(stop);
+
+	for (int f = 1; f + 1 < fragments.size(); f++)
+	{
+		P.history.push_back({ c, fragments[f] });
+		P.cell_stop[fragments[f]] = fragments[f + 1];
+
+		for (int k = fragments[f]; k < fragments[f + 1]; k++)
+		{
+			P.cell_start[P.order[k]] = fragments[f];
+		}
+	}
+
+	P.cell_stop[c] = fragments[1];
+	P.num_cells += fragments.size() - 2;
+
+	if (in_worklist[c]) //c still has to be applied as a whole, so each fragment must be applied
+	{
+		for (int f = 1; f + 1 < fragments.size(); f++)
+		{
+			push(fragments[f]);
+		}
+
+		return;
+	}
+
+	int largest = 0; //first fragment of greatest size; applying the others says everything it would
+
+	for (int f = 1; f + 1 < fragments.size(); f++)
+	{
+		if (fragments[f + 1] - fragments[f] > fragments[largest + 1] - fragments[largest])
+		{
+			largest = f;
+		}
+	}
+
+	for (int f = 0; f + 1 < fragments.size(); f++)
+	{
+		if (f != largest)
+		{
+			push(fragments[f]);
+		}
+	}
+}
+
+void ColorRefinement::refine_worklist(OrderedPartition& P)
+{
+	for (int head = 0; head < worklist.size(); head++)
+	{
+		int s = worklist[head];
+
+		in_worklist[s] = false;
+
+		if (P.is_discrete())
+		{
+			continue;
+		}
+
+		splitter.assign(P.begin(s), P.end(s));
+
+		for (int v : splitter)
+		{
+			for (const int* j = graph.begin(v); j != graph.end(v); j++)
+			{
+				int w = *j;
+				int c = P.cell_start[w];
+
+				if (P.cell_stop[c] == c + 1 || count[w]++ > 0) //singleton cells cannot split
+				{
+					continue;
+				}
+
+				touched_vertices.push_back(w);
+
+				if (cell_touched[c] == 0)
+				{
+					touched_cells.push_back(c);
+				}
+
+				int target = P.cell_stop[c] - ++cell_touched[c]; //gather the touched vertices at the end of their cell
+				int u = P.order[target];
+
+				std::swap(P.order[target], P.order[P.position[w]]);
+				std::swap(P.position[u], P.position[w]);
+			}
+		}
+
+		std::sort(touched_cells.begin(), touched_cells.end()); //cells are split in position order, which keeps the worklist independent of vertex labels
+
+		for (int c : touched_cells)
+		{
+			split(P, c);
+		}
+
+		for (int w : touched_vertices)
+		{
+			count[w] = 0;
+		}
+
+		touched_vertices.clear();
+		touched_cells.clear();
+	}
+
+	worklist.clear();
+}
+
+void ColorRefinement::refine(OrderedPartition& P)
+{
+	for (int c = 0; c < P.size(); c = P.next_cell(c))
+	{
+		push(c);
+	}
+
+	refine_worklist(P);
+}
+
+void ColorRefinement::individualize(OrderedPartition& P, int v)
+{
+	int c = P.cell_start[v];
+	int last = P.cell_stop[c] - 1;
+
+	if (last == c)
+	{
+		return;
+	}
+
+	int u = P.order[last];
+
+	std::swap(P.order[last], P.order[P.position[v]]);
+	std::swap(P.position[u], P.position[v]);
+
+	P.cell_stop[c] = last;
+	P.cell_stop[last] = last + 1;
+	P.cell_start[v] = last;
+	P.num_cells++;
+	P.history.push_back({ c, last });
+
+	push(last);
+	refine_worklist(P);
+}
+
+std::vector<int> ColorRefinement::stable_colors(const CSRGraph& G, const std::vector<int>& colors)
+{
+	OrderedPartition P(colors);
+
+	ColorRefinement(G).refine(P);
+
+	return P.colors();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "Graph.h"
+#include "CSRGraph.h"
+
+class OrderedPartition //partition of 0,...,n-1 into cells, each a contiguous range in an ordering of the vertices; a cell is named by the position where it starts, so names survive relabeling the graph
+{
+
+private:
+
+	std::vector<int> order; //order[k] = vertex at position k
+	std::vector<int> position; //position[v] = k with order[k] = v
+	std::vector<int> cell_start; //cell_start[v] = start of the cell of v
+	std::vector<int> cell_stop; //cell_stop[s] = end of the cell starting at s; only meaningful at cell starts
+
+	int num_cells;
+
+	std::vector<std::pair<int, int>> history; //(c, f) for each fragment f split off cell c, in order, so that splits can be undone
+
+	friend class ColorRefinement;
+
+public:
+
+	OrderedPartition(const std::vector<int>& colors); //one cell per color value, cells in increasing color
+	OrderedPartition(const ColoredSet& colored_set); //members of the set by their colors, then every other vertex in one last cell
+
+	int size() const { return order.size(); }
+	int cells() const { return num_cells; }
+	bool is_discrete() const { return num_cells == size(); }
+
+	int cell(int v) const { return cell_start[v]; }
+	int cell_size(int c) const { return cell_stop[c] - c; }
+	int next_cell(int c) const { return cell_stop[c]; } //cells are visited with c = 0; c < size(); c = next_cell(c)
+
+	const int* begin(int c) const { return order.data() + c; }
+	const int* end(int c) const { return order.data() + cell_stop[c]; }
+
+	const std::vector<int>& vertex_order() const { return order; } //once discrete, order[k] is the vertex in the k-th cell
+	std::vector<int> colors() const; //colors[v] = cell(v)
+
+	int checkpoint() const { return history.size(); }
+	void restore(int checkpoint); //undoes every split made since checkpoint; cells get their vertices back, though not in their old order, which no refinement depends on
+	const std::vector<std::pair<int, int>>& splits() const { return history; } //every split so far, as (cell, start of the new fragment)
+};
+
+class ColorRefinement //refines ordered partitions of a graph to the coarsest equitable partition finer than them (1-WL), Hopcroft style: a split cell queues all its fragments but the largest
+{
+
+private:
+
+	const CSRGraph& graph; //must outlive the engine
+
+	std::vector<int> count; //count[w] = neighbors of w in the current splitter
+	std::vector<int> touched_vertices;
+	std::vector<int> touched_cells;
+	std::vector<int> cell_touched; //number of touched vertices per cell start; they sit at the end of their cell
+
+	std::vector<int> worklist; //cell starts waiting to be used as splitters, first in first out
+	std::vector<bool> in_worklist;
+	std::vector<int> splitter; //copy of the splitter being applied, since applying it may reorder its own cell
+	std::vector<int> fragments;
+
+	void push(int c);
+	void split(OrderedPartition& P, int c); //splits cell c by count; fragments are ordered by increasing count
+	void refine_worklist(OrderedPartition& P);
+
+public:
+
+	ColorRefinement(const CSRGraph& G);
+	ColorRefinement(CSRGraph&& G) = delete; //the engine keeps a reference, so a Graph has to be converted by the caller first
+
+	//Both refinements depend only on the graph and the partition up to relabeling, so isomorphic inputs give corresponding cells; the cost is O((n + m) log n).
+	void refine(OrderedPartition& P); //every cell is a splitter
+	void individualize(OrderedPartition& P, int v); //moves v to a new cell at the end of its cell, then refines with {v} as the only splitter; P should already be equitable
+
+	static std::vector<int> stable_colors(const CSRGraph& G, const std::vector<int>& colors); //colors of the coarsest equitable partition finer than colors; takes a Graph too
+};
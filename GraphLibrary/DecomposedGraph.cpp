@@ -1,5 +1,6 @@
 
 #include "DecomposedGraph.h"
+#include "BreadthFirstSearch.h"
 
 #include <iostream>
 #include <cmath>
@@ -14,64 +15,61 @@ using std::map;
 using std::cout;
 using std::endl;
 
-void DecomposedGraph::decompose(const Graph& G, Edge e)
+void DecomposedGraph::decompose(const CSRGraph& G, Edge e)
 {
-	if (!G.has_edge(e) || e.size() != 2)
+	if (e.size() != 2 || !G.has_edge(*e.begin(), *e.rbegin()))
 	{
 		throw InvalidDecomposition();
 	}
 
 	int n = G.size();
 
-	set<int> v_visited;
-	set<Edge> e_visited;
+	BreadthFirstSearch bfs(G, vector<int>(e.begin(), e.end())); //level d of the search from both ends of e is V(X_{d+1}) minus V(X_d)
 
-	vertices.resize(n);
-	edges.resize(n);
+	const vector<int>& distance = bfs.distance_array();
 
-	vertices[0] = {};
-	edges[0] = {};
+	vertices.assign(n, {});
+	edges.assign(n, {});
 
-	vertices[1] = e;
 	edges[1] = { e };
 
-	e_visited.insert(e);
+	for (int d = 0; d < bfs.levels(); d++)
+	{
+		vertices[d + 1] = set<int>(bfs.begin(d), bfs.end(d)); //levels are sorted, so this takes linear time
+	}
 
-	v_visited = e;
-	
-	for (int i = 2; i < n; i++)
+	for (int d = 0; d < bfs.levels() && d + 2 < n; d++) //E(X_{d+2}) gets the edges from level d that were not already in E(X_{d+1}): those to level d+1, and those within level d unless d = 0, where that is e
 	{
-		for (int j : vertices[i - 1]) //for each vertex j in X_{i-1}
+		for (const int* j = bfs.begin(d); j != bfs.end(d); j++)
 		{
-			for (int k : G.adj_list()[j]) //for each vertex adjacent to j
+			for (const int* k = G.begin(*j); k != G.end(*j); k++)
 			{
-				Edge new_edge({ j, k });
-
-				if (!e_visited.count(new_edge))
+				if (distance[*k] > d || (distance[*k] == d && d > 0 && *j < *k))
 				{
-					edges[i].insert(new_edge);
-					e_visited.insert(new_edge);
-				}
-				
-				if (!v_visited.count(k))
-				{
-					vertices[i].insert(k);
-					v_visited.insert(k);
+					edges[d + 2].insert(Edge({ *j, *k }));
 				}
 			}
 		}
-
-		if (e_visited.size() == G.edges())
-		{
-			break;
-		}
 	}
 }
 
 DecomposedGraph::DecomposedGraph(const Graph& G, Edge root_edge):
+	graph(G),
 	base_graph(G)
 {
-	decompose(G, root_edge);
+	decompose(graph, root_edge);
+}
+
+int DecomposedGraph::layers() const
+{
+	int r = 1;
+
+	while (r + 1 < vertices.size() && !vertices[r + 1].empty())
+	{
+		r++;
+	}
+
+	return r;
 }
 
 void DecomposedGraph::print_decomposition()
@@ -156,18 +154,18 @@ ColoredSetCollection DecomposedGraph::construct_colored_sets(int r)
 	{
 		std::set<int> image;
 
-		for (int j : base_graph.adj_list()[i])
+		for (const int* j = graph.begin(i); j != graph.end(i); j++)
 		{
-			if (vertices[r].count(j))
+			if (vertices[r].count(*j))
 			{
-				image.insert(j);
+				image.insert(*j);
 			}
 		}
 
 		pre_image_map[image].insert(i);
 	}
 
-	int t = base_graph.max_degree();
+	int t = graph.max_degree();
 
 	vector<set<set<int>>> A(t); //A[i] = sets with preimage of size i
 
@@ -201,7 +199,10 @@ ColoredSetCollection DecomposedGraph::construct_colored_sets(int r)
 		set<set<int>> intersection; //A_i ^ A'
 		std::set_intersection(A[i].begin(), A[i].end(), new_edges.begin(), new_edges.end(), std::inserter(intersection, intersection.end()));
 
-		new_edges.erase(intersection.begin(), intersection.end());
+		for (const set<int>& s : intersection)
+		{
+			new_edges.erase(s);
+		}
 
 		for (set<int> s : intersection)
 		{
@@ -234,4 +235,22 @@ void ColoredSetCollection::print()
 
 		cout << " }, color: " << pair.second << endl;
 	}
-}
\ No newline at end of file
+}
+
+int ReductionMap::add(const std::set<int>& s)
+{
+	auto found = points.find(s);
+
+	if (found != points.end())
+	{
+		return found->second;
+	}
+
+	int k = sets.size();
+
+	sets.push_back(s);
+	points[s] = k;
+	point_colors.push_back(original_collection.colors.count(s) ? original_collection.colors.at(s) : 0);
+
+	return k;
+}
@@ -4,6 +4,7 @@
 #include <map>
 
 #include "Graph.h"
+#include "CSRGraph.h"
 
 struct ColoredSetCollection;
 
@@ -15,7 +16,9 @@ private:
 	std::vector<std::set<int>> vertices; // V(X_0) = empty, ... , V(X_{n-1})
 	std::vector<std::set<Edge>> edges; // E(X_0) = empty, ... , E(X_{n-1})
 
-	void decompose(const Graph& G, Edge root); // sets vertices and edge sets to decomposition of G around root edge 
+	CSRGraph graph; //base_graph in CSR form, for the neighbor scans
+
+	void decompose(const CSRGraph& G, Edge root); // sets vertices and edge sets to decomposition of G around root edge 
 
 public:
 
@@ -25,6 +28,9 @@ public:
 
 	void print_decomposition();
 
+	int layers() const; //largest r with V(X_r) non-empty; X_1, ... , X_layers() cover the component of the root edge
+	const std::set<int>& layer(int r) const { return vertices[r]; } //V(X_r), the vertices at distance r-1 from the root edge
+
 	ColoredSetCollection construct_colored_sets(int r); // returns colored subsets of X_r;
 
 };
@@ -40,10 +46,16 @@ struct ColoredSetCollection
 	void print();
 };
 
-struct ReductionMap
+struct ReductionMap //the colored sets of one layer, closed under a group acting on the vertices, as a string over points: set k becomes point k with color point_colors[k]
 {
 	ColoredSetCollection original_collection;
 
+	std::vector<std::set<int>> sets; //sets[k] = set at point k; the colored sets first, then the rest of their orbits
+	std::map<std::set<int>, int> points; //inverse of sets
+	std::vector<int> point_colors; //color of sets[k] in original_collection, 0 for sets it does not color
+
+	int size() const { return sets.size(); }
+	int add(const std::set<int>& s); //point of s, appending it if it is new
 };
 
 class InvalidDecomposition : public std::exception
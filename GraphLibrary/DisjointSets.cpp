@@ -0,0 +1,85 @@
+#include "DisjointSets.h"
+
+using std::vector;
+
+DisjointSets::DisjointSets(int size) :
+	parent(vector<int>(size)),
+	rank(vector<int>(size, 0)),
+	num_sets(size)
+{
+	for (int i = 0; i < size; i++)
+	{
+		parent[i] = i;
+	}
+}
+
+int DisjointSets::find(int i)
+{
+	int root = i;
+
+	while (parent[root] != root)
+	{
+		root = parent[root];
+	}
+
+	while (parent[i] != root) //compress path
+	{
+		int next = parent[i];
+		parent[i] = root;
+		i = next;
+	}
+
+	return root;
+}
+
+int DisjointSets::unite(int i, int j)
+{
+	i = find(i);
+	j = find(j);
+
+	if (i == j)
+	{
+		return -1;
+	}
+
+	if (rank[i] < rank[j])
+	{
+		int tmp = i;
+		i = j;
+		j = tmp;
+	}
+
+	parent[j] = i;
+
+	if (rank[i] == rank[j])
+	{
+		rank[i]++;
+	}
+
+	num_sets--;
+
+	return j;
+}
+
+vector<int> DisjointSets::labels()
+{
+	vector<int> out(parent.size(), -1);
+	vector<int> root_label(parent.size(), -1);
+
+	int next_label = 0;
+
+	for (int i = 0; i < parent.size(); i++)
+	{
+		int root = find(i);
+
+		if (root_label[root] == -1)
+		{
+			root_label[root] = next_label;
+			next_label++;
+		}
+
+		out[i] = root_label[root];
+	}
+
+	return out;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+class DisjointSets //union-find over 0,...,n-1 with path compression and union by rank
+{
+
+private:
+
+	std::vector<int> parent;
+	std::vector<int> rank;
+
+	int num_sets;
+
+public:
+
+	DisjointSets(int size); //creates the singletons {0}, ... , {size-1}
+
+	int size() const { return parent.size(); }
+	int sets() const { return num_sets; } //number of disjoint sets currently held
+
+	int find(int i); //returns the representative of the set containing i
+	int unite(int i, int j); //merges the sets containing i and j; returns the representative which was absorbed, or -1 if i and j were already in the same set
+
+	std::vector<int> labels(); //labels[i] = index of the set containing i, where sets are numbered 0,1,... in order of their smallest element
+};
@@ -1,9 +1,16 @@
 #include "Graph.h"
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <iterator>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 #include "DecomposedGraph.h"
+#include "CSRGraph.h"
 
 using std::vector;
 using std::set;
@@ -17,22 +24,55 @@ Graph::Graph(int size):
 	n(size),
 	adj(vector<set<int>>(n)),
 	colors(vector<int>(n)),
-	num_edges(0)
+	num_edges(0),
+	mode(AdjacencyMode::automatic),
+	words((size + 63) / 64),
+	edge_hash(0)
 {}
 
+static vector<std::pair<int, int>> edge_array(const vector<set<int>>& adj_list)
+{
+	vector<std::pair<int, int>> out;
+
+	for (int i = 0; i < adj_list.size(); i++)
+	{
+		for (int j : adj_list[i])
+		{
+			out.emplace_back(i, j);
+		}
+	}
+
+	return out;
+}
+
 Graph::Graph(const vector<set<int>>& adj_list) :
-	n(adj_list.size()),
+	Graph(CSRGraph(adj_list.size(), edge_array(adj_list)))
+{}
+
+Graph::Graph(int size, const std::vector<std::pair<int, int>>& edge_list) :
+	Graph(CSRGraph(size, edge_list))
+{}
+
+Graph::Graph(const CSRGraph& G) :
+	n(G.size()),
 	adj(vector<set<int>>(n)),
 	colors(vector<int>(n)),
-	num_edges(0)
+	num_edges(G.edges()),
+	mode(AdjacencyMode::automatic),
+	words((G.size() + 63) / 64),
+	edge_hash(0)
 {
-	for (int i = 0; i < adj_list.size(); i++)
+	for (int i = 0; i < n; i++)
 	{
-		for (auto j = adj_list[i].begin(); j != adj_list[i].end(); j++)
+		adj[i] = set<int>(G.begin(i), G.end(i)); //sorted input, so no searching
+
+		for (const int* j = std::upper_bound(G.begin(i), G.end(i), i); j != G.end(i); j++)
 		{
-			insert_edge(i, *j);
+			edge_hash ^= pair_hash(i, *j);
 		}
 	}
+
+	update_density();
 }
 
 std::vector<std::set<int>> const Graph::get_adj() const
@@ -40,9 +80,24 @@ std::vector<std::set<int>> const Graph::get_adj() const
 	return adj;
 }
 
-bool Graph::operator==(const Graph& h)
+uint64_t Graph::pair_hash(int i, int j)
+{
+	uint64_t x = (uint64_t)std::min(i, j) << 32 | (uint32_t)std::max(i, j); //splitmix64 finalizer
+
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+
+	return x ^ (x >> 31);
+}
+
+bool Graph::operator==(const Graph& h) const
 {
-	return adj == h.get_adj();
+	if (n != h.n || num_edges != h.num_edges || edge_hash != h.edge_hash)
+	{
+		return false;
+	}
+
+	return adj == h.adj;
 }
 
 bool const Graph::has_edge(int i, int j) const 
@@ -52,6 +107,11 @@ bool const Graph::has_edge(int i, int j) const
 		return false;
 	}
 
+	if (is_dense())
+	{
+		return j >= 0 && j < n && (row(i)[j / 64] >> (j % 64) & 1);
+	}
+
 	return (adj[i].count(j));
 }
 
@@ -81,19 +141,467 @@ bool Graph::insert_edge(int i, int j)
 		adj[j].insert(i);
 
 		num_edges++;
+		edge_hash ^= pair_hash(i, j);
+
+		if (is_dense())
+		{
+			bit_rows[(size_t)i * words + j / 64] |= uint64_t(1) << (j % 64);
+			bit_rows[(size_t)j * words + i / 64] |= uint64_t(1) << (i % 64);
+		}
+
+		else if (mode == AdjacencyMode::automatic)
+		{
+			update_density();
+		}
 	}
 	return true;
 }
 
 void Graph::delete_edge(int i, int j)
 {
+	if (i < 0 || i >= n || j < 0 || j >= n)
+	{
+		return;
+	}
+
 	if (adj[i].count(j))
 	{
 		adj[i].erase(j);
 		adj[j].erase(i);
 
 		num_edges--;
+		edge_hash ^= pair_hash(i, j);
+
+		if (is_dense())
+		{
+			bit_rows[(size_t)i * words + j / 64] &= ~(uint64_t(1) << (j % 64));
+			bit_rows[(size_t)j * words + i / 64] &= ~(uint64_t(1) << (i % 64));
+		}
+	}
+}
+
+static vector<std::pair<int, int>> directed_pairs(int n, const vector<std::pair<int, int>>& edge_list) //both directions of every valid pair, sorted and without repeats
+{
+	vector<std::pair<int, int>> out;
+
+	out.reserve(2 * edge_list.size());
+
+	for (auto e : edge_list)
+	{
+		if (e.first >= 0 && e.first < n && e.second >= 0 && e.second < n && e.first != e.second)
+		{
+			out.emplace_back(e.first, e.second);
+			out.emplace_back(e.second, e.first);
+		}
+	}
+
+	std::sort(out.begin(), out.end());
+	out.erase(std::unique(out.begin(), out.end()), out.end());
+
+	return out;
+}
+
+template<class F>
+static void for_each_row(const vector<std::pair<int, int>>& pairs, vector<set<int>>& adj, F f) //calls f(i, j, it) for each pair (i, j) with it at the first neighbor of i not below j; rows with few pairs for their size are searched, the rest walked
+{
+	for (size_t first = 0, last = 0; first < pairs.size(); first = last)
+	{
+		int i = pairs[first].first;
+
+		while (last < pairs.size() && pairs[last].first == i)
+		{
+			last++;
+		}
+
+		set<int>& row = adj[i];
+
+		bool search = 16 * (last - first) < row.size();
+		auto it = row.begin();
+
+		for (size_t k = first; k < last; k++)
+		{
+			int j = pairs[k].second;
+
+			if (search)
+			{
+				it = row.lower_bound(j);
+			}
+
+			else
+			{
+				while (it != row.end() && *it < j)
+				{
+					it++;
+				}
+			}
+
+			it = f(i, j, it);
+		}
+	}
+}
+
+int Graph::insert_edges(const std::vector<std::pair<int, int>>& edge_list)
+{
+	int added = 0;
+
+	for_each_row(directed_pairs(n, edge_list), adj, [&](int i, int j, set<int>::iterator it) //the graph is symmetric, so j is new to i exactly when i is new to j
+	{
+		if (it != adj[i].end() && *it == j)
+		{
+			return it;
+		}
+
+		it = adj[i].emplace_hint(it, j);
+
+		if (i < j)
+		{
+			added++;
+			edge_hash ^= pair_hash(i, j);
+		}
+
+		if (is_dense())
+		{
+			bit_rows[(size_t)i * words + j / 64] |= uint64_t(1) << (j % 64);
+		}
+
+		return ++it;
+	});
+
+	num_edges += added;
+
+	if (!is_dense() && mode == AdjacencyMode::automatic)
+	{
+		update_density();
+	}
+
+	return added;
+}
+
+int Graph::delete_edges(const std::vector<std::pair<int, int>>& edge_list)
+{
+	int removed = 0;
+
+	for_each_row(directed_pairs(n, edge_list), adj, [&](int i, int j, set<int>::iterator it)
+	{
+		if (it == adj[i].end() || *it != j)
+		{
+			return it;
+		}
+
+		if (i < j)
+		{
+			removed++;
+			edge_hash ^= pair_hash(i, j);
+		}
+
+		if (is_dense())
+		{
+			bit_rows[(size_t)i * words + j / 64] &= ~(uint64_t(1) << (j % 64));
+		}
+
+		return adj[i].erase(it);
+	});
+
+	num_edges -= removed;
+
+	return removed;
+}
+
+int Graph::add_vertices(int count)
+{
+	int first = n;
+
+	if (count <= 0)
+	{
+		return first;
+	}
+
+	n += count;
+	adj.resize(n);
+	colors.resize(n);
+	words = (n + 63) / 64;
+
+	if (is_dense()) //the rows get longer
+	{
+		build_bit_rows();
+	}
+
+	return first;
+}
+
+std::vector<int> Graph::remove_vertices(const std::vector<int>& vertices)
+{
+	vector<int> label(n, 0);
+
+	int lowest = n; //vertices below it, with no neighbors from it on, keep their labels and adjacency sets
+
+	for (int v : vertices)
+	{
+		if (v >= 0 && v < n)
+		{
+			label[v] = -1;
+			lowest = std::min(lowest, v);
+		}
+	}
+
+	int kept = 0;
+
+	for (int v = 0; v < n; v++)
+	{
+		if (label[v] != -1)
+		{
+			label[v] = kept++;
+		}
+	}
+
+	vector<set<int>> new_adj(kept);
+	vector<int> row;
+
+	num_edges = 0;
+	edge_hash = 0;
+
+	for (int v = 0; v < n; v++)
+	{
+		if (label[v] == -1)
+		{
+			continue;
+		}
+
+		if (v < lowest && (adj[v].empty() || *adj[v].rbegin() < lowest))
+		{
+			new_adj[v].swap(adj[v]);
+		}
+
+		else
+		{
+			row.clear();
+
+			for (int w : adj[v])
+			{
+				if (label[w] != -1)
+				{
+					row.push_back(label[w]); //labels keep their order, so the row stays sorted
+				}
+			}
+
+			new_adj[label[v]] = set<int>(row.begin(), row.end());
+		}
+
+		for (auto w = new_adj[label[v]].upper_bound(label[v]); w != new_adj[label[v]].end(); w++)
+		{
+			num_edges++;
+			edge_hash ^= pair_hash(label[v], *w);
+		}
+	}
+
+	adj.swap(new_adj);
+
+	n = kept;
+	colors.assign(n, 0);
+	words = (n + 63) / 64;
+
+	if (is_dense())
+	{
+		build_bit_rows();
+	}
+
+	return label;
+}
+
+void Graph::build_bit_rows()
+{
+	bit_rows.assign((size_t)n * words, 0);
+
+	for (int i = 0; i < n; i++)
+	{
+		for (int j : adj[i])
+		{
+			bit_rows[(size_t)i * words + j / 64] |= uint64_t(1) << (j % 64);
+		}
+	}
+}
+
+void Graph::update_density()
+{
+	if (n > 0 && (long long)num_edges * 640 >= (long long)n * n) //n^2/8 bytes of bits against about 80 bytes of tree nodes per edge
+	{
+		build_bit_rows();
+	}
+}
+
+void Graph::set_adjacency_mode(AdjacencyMode new_mode)
+{
+	mode = new_mode;
+
+	if (mode == AdjacencyMode::dense)
+	{
+		if (!is_dense())
+		{
+			build_bit_rows();
+		}
+	}
+
+	else if (mode == AdjacencyMode::sparse)
+	{
+		bit_rows.clear();
+		bit_rows.shrink_to_fit();
+	}
+
+	else if (!is_dense())
+	{
+		update_density();
+	}
+}
+
+static int popcount64(uint64_t x)
+{
+#if defined(_MSC_VER)
+	return (int)__popcnt64(x);
+#else
+	return __builtin_popcountll(x);
+#endif
+}
+
+int Graph::common_neighbors(int i, int j) const
+{
+	if (is_dense())
+	{
+		const uint64_t* a = row(i);
+		const uint64_t* b = row(j);
+
+		int count = 0;
+
+		for (int w = 0; w < words; w++) //plain loop over words, left for the compiler to vectorize
+		{
+			count += popcount64(a[w] & b[w]);
+		}
+
+		return count;
+	}
+
+	int count = 0;
+
+	auto a = adj[i].begin();
+	auto b = adj[j].begin();
+
+	while (a != adj[i].end() && b != adj[j].end())
+	{
+		if (*a < *b)
+		{
+			a++;
+		}
+
+		else if (*b < *a)
+		{
+			b++;
+		}
+
+		else
+		{
+			count++;
+			a++;
+			b++;
+		}
+	}
+
+	return count;
+}
+
+int Graph::neighborhood_union_size(int i, int j) const
+{
+	if (is_dense())
+	{
+		const uint64_t* a = row(i);
+		const uint64_t* b = row(j);
+
+		int count = 0;
+
+		for (int w = 0; w < words; w++)
+		{
+			count += popcount64(a[w] | b[w]);
+		}
+
+		return count;
+	}
+
+	return degree(i) + degree(j) - common_neighbors(i, j);
+}
+
+static int lowest_bit64(uint64_t x) //x != 0
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, x);
+	return (int)index;
+#else
+	return __builtin_ctzll(x);
+#endif
+}
+
+static std::vector<int> bits_to_vertices(const std::vector<uint64_t>& bits)
+{
+	vector<int> out;
+
+	for (int w = 0; w < bits.size(); w++)
+	{
+		uint64_t word = bits[w];
+
+		while (word != 0)
+		{
+			out.push_back(w * 64 + lowest_bit64(word));
+			word &= word - 1; //clear the lowest set bit
+		}
 	}
+
+	return out;
+}
+
+std::vector<int> Graph::neighborhood_intersection(int i, int j) const
+{
+	if (is_dense())
+	{
+		vector<uint64_t> bits(words);
+
+		const uint64_t* a = row(i);
+		const uint64_t* b = row(j);
+
+		for (int w = 0; w < words; w++)
+		{
+			bits[w] = a[w] & b[w];
+		}
+
+		return bits_to_vertices(bits);
+	}
+
+	vector<int> out;
+
+	std::set_intersection(adj[i].begin(), adj[i].end(), adj[j].begin(), adj[j].end(), std::back_inserter(out));
+
+	return out;
+}
+
+std::vector<int> Graph::neighborhood_union(int i, int j) const
+{
+	if (is_dense())
+	{
+		vector<uint64_t> bits(words);
+
+		const uint64_t* a = row(i);
+		const uint64_t* b = row(j);
+
+		for (int w = 0; w < words; w++)
+		{
+			bits[w] = a[w] | b[w];
+		}
+
+		return bits_to_vertices(bits);
+	}
+
+	vector<int> out;
+
+	std::set_union(adj[i].begin(), adj[i].end(), adj[j].begin(), adj[j].end(), std::back_inserter(out));
+
+	return out;
 }
 
 int Graph::degree(int i) const
@@ -129,21 +637,55 @@ Graph Graph::gnp_random(int n, float p, RandomNumberEngine& rand_eng)
 {
 	p = std::clamp(p, 0.0f, 1.0f);
 
-	Graph out = Graph(n);
+	vector<std::pair<int, int>> edge_list; //built in one batch at the end
 
-	for (int i = 0; i < n - 1; i++)
+	if (p == 0)
 	{
-		for (int j = i + 1; j < n; j++)
-		{
-			float draw = rand_eng.random_float();
+		return Graph(n);
+	}
 
-			if (draw <= p)
+	if (p == 1)
+	{
+		for (int i = 0; i < n - 1; i++)
+		{
+			for (int j = i + 1; j < n; j++)
 			{
-				out.insert_edge(i, j);
+				edge_list.emplace_back(i, j);
 			}
 		}
+
+		return Graph(n, edge_list);
 	}
-	return out;
+
+	double log_q = std::log1p(-(double)p);
+
+	long long v = 1; //pairs (v, w) with w < v, in row-major order; the gap before each edge is geometric (Batagelj-Brandes), so the cost is O(n + m)
+	long long w = -1;
+
+	while (v < n)
+	{
+		double skip = std::floor(std::log1p(-rand_eng.random_double()) / log_q);
+
+		if (skip > 4e18)
+		{
+			break;
+		}
+
+		w += 1 + (long long)skip;
+
+		while (w >= v && v < n)
+		{
+			w -= v;
+			v++;
+		}
+
+		if (v < n)
+		{
+			edge_list.emplace_back(v, w);
+		}
+	}
+
+	return Graph(n, edge_list);
 }
 
 void const Graph::print()
@@ -157,80 +699,134 @@ void const Graph::print()
 			cout << *j << ", ";
 		}
 
-		cout << endl;
+		cout << '\n'; //one flush at the end rather than one per vertex
 	}
+
+	cout.flush();
 }
 
-std::set<int> const Graph::con_comp(int i) 
+static const int parallel_search_edges = 1 << 20; //below this many edges, or with one thread, con_comp searches adj itself instead of copying the graph for BreadthFirstSearch
+
+std::set<int> const Graph::con_comp(int i, int threads) 
 {
 	if (i < 0 || i >= n)
 	{
 		return {};
 	}
 
-	clear_colors();
-
-	std::queue<int> Q;
-
-	Q.push(i);
+	if (num_edges >= parallel_search_edges && threads != 1) //the copy is O(n + m) like the search itself, and buys its parallel levels
+	{
+		return CSRGraph(*this).con_comp(i, threads);
+	}
 
-	colors[i] = 1;
+	std::vector<bool> seen(n, false);
+	std::vector<int> queue = { i };
 
-	std::set<int> out = { i };
+	seen[i] = true;
 
-	while (!Q.empty())
+	for (int k = 0; k < queue.size(); k++)
 	{
-		int current = Q.front();
-		Q.pop();
-
-		for (auto j = adj[current].begin(); j != adj[current].end(); j++)
+		for (int j : adj[queue[k]])
 		{
-			if (colors[*j] == 0)
+			if (!seen[j])
 			{
-				out.insert(*j);
-				Q.push(*j);
-				colors[*j] = 1;
+				seen[j] = true;
+				queue.push_back(j);
 			}
 		}
 	}
 
-	clear_colors();
-
-	return out;
+	return std::set<int>(queue.begin(), queue.end());
 }
 
 std::vector<std::set<int>> const Graph::conn_components()
 {
-	std::set<int> unfound_vertices = {};
+	ComponentLabels labels = component_labels();
 
-	for (int i = 0; i < n; i++)
+	std::vector<std::set<int>> out(labels.count());
+
+	for (int v = 0; v < n; v++)
 	{
-		unfound_vertices.insert(i);
+		out[labels.component[v]].insert(out[labels.component[v]].end(), v); //increasing, so each insert is at the end
 	}
 
-	std::vector<std::set<int>> out;
+	return out;
+}
+
+ComponentLabels Graph::component_labels() const
+{
+	ComponentLabels out;
+
+	out.component.assign(n, -1);
+
+	std::vector<int> queue;
+	queue.reserve(n);
 
-	while (!unfound_vertices.empty())
+	for (int start = 0; start < n; start++)
 	{
-		int next_vert = *unfound_vertices.begin();
+		if (out.component[start] != -1)
+		{
+			continue;
+		}
+
+		int c = out.count();
 
-		std::set<int> conn_comp = con_comp(next_vert);
+		queue.assign(1, start);
+		out.component[start] = c;
 
-		for (int i : conn_comp)
+		for (int k = 0; k < queue.size(); k++)
 		{
-			unfound_vertices.erase(i);
+			for (int j : adj[queue[k]])
+			{
+				if (out.component[j] == -1)
+				{
+					out.component[j] = c;
+					queue.push_back(j);
+				}
+			}
 		}
-		//unfound_vertices.erase(conn_comp.begin(), conn_comp.end());
 
-		out.push_back(conn_comp);
+		out.sizes.push_back(queue.size());
 	}
 
 	return out;
 }
 
-
 bool const Graph::is_connected() 
 {
-	return (con_comp(0).size() == n);
+	if (n <= 1)
+	{
+		return true;
+	}
+
+	if (num_edges < n - 1)
+	{
+		return false;
+	}
+
+	vector<bool> reached(n, false);
+	vector<int> queue = { 0 };
+
+	queue.reserve(n);
+	reached[0] = true;
+
+	for (int k = 0; k < queue.size(); k++) //stops as soon as every vertex is reached
+	{
+		for (int j : adj[queue[k]])
+		{
+			if (!reached[j])
+			{
+				reached[j] = true;
+				queue.push_back(j);
+
+				if (queue.size() == n)
+				{
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
 }
 
@@ -2,12 +2,30 @@
 
 #include <vector>
 #include <set>
+#include <utility>
+#include <cstdint>
 
 #include "RandomNumberEngine/RandomNumberEngine.h"
 
 using Edge = std::set<int>;
 
 class DecomposedGraph;
+class CSRGraph;
+
+enum class AdjacencyMode
+{
+	sparse, //adjacency sets only
+	dense, //adjacency sets plus one bit row per vertex: O(1) has_edge and word-parallel neighborhood operations
+	automatic //turns dense once the bit rows take no more memory than the set nodes they shadow (about m >= n^2 / 640); never turns back by itself
+};
+
+struct ComponentLabels //component[v] is the id of the component of v; ids run from 0 in order of the smallest vertex of each component
+{
+	std::vector<int> component;
+	std::vector<int> sizes; //sizes[c] is the number of vertices with id c
+
+	int count() const { return sizes.size(); }
+};
 
 class Graph
 {
@@ -21,32 +39,63 @@ private:
 
 	std::vector<int> colors; // for internal use in algorithms (BFS, DFS, etc.); not the same as a "colored graph"
 
+	AdjacencyMode mode;
+	int words; //64-bit words per bit row
+	std::vector<uint64_t> bit_rows; //bit j of row i is set iff i ~ j; empty unless dense
+
+	uint64_t edge_hash; //XOR of a hash of every edge {i, j}; kept up to date by every mutation, so unequal graphs almost always differ here
+
 	void clear_colors(); //sets all entries of colors vector to 0	
 
+	const uint64_t* row(int i) const { return bit_rows.data() + (size_t)i * words; }
+	void build_bit_rows();
+	void update_density(); //automatic mode: builds the bit rows once the graph is dense enough
+
+	static uint64_t pair_hash(int i, int j);
+
 public:
 
 	Graph(int size); //creates a graph on size vertices with no edges
-	Graph(const std::vector<std::set<int>>& adj_list); //creates a graph based on given adjacency list 
+	Graph(const std::vector<std::set<int>>& adj_list); //creates a graph based on given adjacency list; built like the edge array of all its entries, so an entry listed at one end only still gives an edge
+	Graph(int size, const std::vector<std::pair<int, int>>& edge_list); //like inserting each edge into Graph(size): self-loops, repeats and out of range pairs are skipped; the pairs are counting sorted by vertex first, so each adjacency set is built in one linear pass
+	explicit Graph(const CSRGraph& G); //each sorted neighbor row becomes an adjacency set in linear time
 
 	int size() const { return n; }; //number of vertices
 
 	bool insert_edge(int i, int j); //inserts edge between i and j, returning false if vertices do not exist or are the same and true otherwise
 	void delete_edge(int i, int j); //deletes the edge between i and j, or does nothing if this is not possible for whatever reason
 
+	//Batches: the pairs are sorted by vertex, then each adjacency set they touch is updated in one pass. Invalid pairs are skipped as by insert_edge and delete_edge.
+	int insert_edges(const std::vector<std::pair<int, int>>& edge_list); //returns the number of edges which were not already there
+	int delete_edges(const std::vector<std::pair<int, int>>& edge_list); //returns the number of edges removed
+
+	int add_vertices(int count = 1); //adds isolated vertices n, ..., n+count-1 and returns the first of them
+	std::vector<int> remove_vertices(const std::vector<int>& vertices); //removes the vertices and their edges; the rest keep their order and are renumbered from 0; returns the new label of every old vertex, -1 for removed ones
+
 	bool const has_edge(int i, int j) const;
 	bool const has_edge(Edge e) const;
 
 	int const edges() const { return num_edges; }
 
+	AdjacencyMode adjacency_mode() const { return mode; }
+	void set_adjacency_mode(AdjacencyMode new_mode); //dense builds the bit rows now, sparse drops them, automatic decides by density now and on each insertion
+	bool is_dense() const { return !bit_rows.empty(); }
+
+	int common_neighbors(int i, int j) const; //|N(i) ^ N(j)|; popcount over the AND of two bit rows when dense
+	int neighborhood_union_size(int i, int j) const; //|N(i) u N(j)|
+	std::vector<int> neighborhood_intersection(int i, int j) const; //N(i) ^ N(j), in increasing order
+	std::vector<int> neighborhood_union(int i, int j) const;
+
 	bool const is_connected();
 
 	int degree(int i) const; 
 	int max_degree() const;
 
-	std::set<int> const con_comp(int i); //returns set of vertices which are connected to i; uses BFS
+	std::set<int> const con_comp(int i, int threads = 0); //returns set of vertices which are connected to i; large graphs go through the parallel BFS of CSRGraph::con_comp, small ones or threads = 1 through a BFS over adj; for many queries on a large graph, build a CSRGraph once
 	std::vector<std::set<int>> const conn_components();
+	ComponentLabels component_labels() const; //component id of every vertex and the size of every component, in O(n + m) over adj
 
-	static Graph gnp_random(int n, float p, RandomNumberEngine& rand_eng); //returns a graph drawn randomly according to the G(n,p) model; p is clamped to the range [0,1]
+	static Graph gnp_random(int n, float p, RandomNumberEngine& rand_eng); //returns a graph drawn randomly according to the G(n,p) model; p is clamped to the range [0,1]; skips between edges geometrically (see CSRGraph::gnp_random for the CSR, parallel version)
 
 	void const print();
 
@@ -54,7 +103,9 @@ public:
 	
 	const std::vector<std::set<int>>& adj_list() const {return adj;};
 
-	bool operator==(const Graph& h);
+	uint64_t labeled_hash() const { return edge_hash; } //depends on the labels; for a hash shared by isomorphic graphs see GraphInvariants.h
+
+	bool operator==(const Graph& h) const; //same vertices and edges; compares sizes and labeled hashes first, and never copies
 };
 
 struct ColoredSet
@@ -0,0 +1,810 @@
+#include "GraphIO.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstdint>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using std::vector;
+using std::pair;
+using std::string;
+
+class MappedFile //read-only view of a whole file; empty files give an empty range
+{
+
+private:
+
+	const char* data = nullptr;
+	size_t length = 0;
+
+#if defined(_WIN32)
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = NULL;
+#else
+	int fd = -1;
+#endif
+
+	void release(); //unmaps and closes whatever has been opened so far
+
+public:
+
+	MappedFile(const string& path);
+	~MappedFile() { release(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const char* begin() const { return data; }
+	const char* end() const { return data + length; }
+	size_t size() const { return length; }
+};
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const string& path)
+{
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+	LARGE_INTEGER file_size;
+
+	if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &file_size))
+	{
+		release();
+		throw InvalidGraphFile();
+	}
+
+	length = file_size.QuadPart;
+
+	if (length == 0)
+	{
+		return;
+	}
+
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	data = mapping ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+	if (!data)
+	{
+		length = 0;
+		release();
+		throw InvalidGraphFile();
+	}
+}
+
+void MappedFile::release()
+{
+	if (data)
+	{
+		UnmapViewOfFile(data);
+	}
+
+	if (mapping)
+	{
+		CloseHandle(mapping);
+	}
+
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(file);
+	}
+
+	data = nullptr;
+	mapping = NULL;
+	file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile(const string& path)
+{
+	fd = open(path.c_str(), O_RDONLY);
+
+	struct stat info;
+
+	if (fd < 0 || fstat(fd, &info) != 0)
+	{
+		release();
+		throw InvalidGraphFile();
+	}
+
+	length = info.st_size;
+
+	if (length == 0)
+	{
+		return;
+	}
+
+	void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	if (view == MAP_FAILED)
+	{
+		length = 0;
+		release();
+		throw InvalidGraphFile();
+	}
+
+	madvise(view, length, MADV_SEQUENTIAL);
+	data = (const char*)view;
+}
+
+void MappedFile::release()
+{
+	if (data)
+	{
+		munmap((void*)data, length);
+	}
+
+	if (fd >= 0)
+	{
+		close(fd);
+	}
+
+	data = nullptr;
+	fd = -1;
+}
+
+#endif
+
+class BufferedWriter //collects output in a fixed buffer and hands it to fwrite in large blocks
+{
+
+private:
+
+	FILE* file;
+	vector<char> buffer;
+	size_t used = 0;
+
+	void flush()
+	{
+		if (used > 0 && fwrite(buffer.data(), 1, used, file) != used)
+		{
+			throw InvalidGraphFile();
+		}
+
+		used = 0;
+	}
+
+public:
+
+	BufferedWriter(const string& path) :
+		file(fopen(path.c_str(), "wb")),
+		buffer(1 << 20)
+	{
+		if (!file)
+		{
+			throw InvalidGraphFile();
+		}
+	}
+
+	~BufferedWriter()
+	{
+		if (file)
+		{
+			fclose(file);
+		}
+	}
+
+	BufferedWriter(const BufferedWriter&) = delete;
+	BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+	void put(char c)
+	{
+		if (used == buffer.size())
+		{
+			flush();
+		}
+
+		buffer[used++] = c;
+	}
+
+	void put(const char* s)
+	{
+		for (; *s; s++)
+		{
+			put(*s);
+		}
+	}
+
+	void put_int(long long x)
+	{
+		if (buffer.size() - used < 24)
+		{
+			flush();
+		}
+
+		used = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), x).ptr - buffer.data();
+	}
+
+	void close() //flushes and closes, throwing if anything failed to reach the file
+	{
+		flush();
+
+		int status = fclose(file);
+		file = nullptr;
+
+		if (status != 0)
+		{
+			throw InvalidGraphFile();
+		}
+	}
+};
+
+static void skip_blanks(const char*& p, const char* end)
+{
+	while (p != end && (*p == ' ' || *p == '\t' || *p == '\r'))
+	{
+		p++;
+	}
+}
+
+static void skip_line(const char*& p, const char* end)
+{
+	p = std::find(p, end, '\n');
+
+	if (p != end)
+	{
+		p++;
+	}
+}
+
+static long long parse_int(const char*& p, const char* end) //reads a nonnegative decimal after optional blanks; throws if there is none or it does not fit an int
+{
+	skip_blanks(p, end);
+
+	if (p == end || *p < '0' || *p > '9')
+	{
+		throw InvalidGraphFile();
+	}
+
+	long long x = 0;
+
+	for (; p != end && *p >= '0' && *p <= '9'; p++)
+	{
+		x = 10 * x + (*p - '0');
+
+		if (x > INT32_MAX)
+		{
+			throw InvalidGraphFile();
+		}
+	}
+
+	return x;
+}
+
+CSRGraph read_edge_list(const std::string& path)
+{
+	MappedFile file(path);
+
+	vector<pair<int, int>> edge_list;
+	edge_list.reserve(file.size() / 8); //a guess at bytes per line; saves most of the regrowth on large files
+
+	int max_label = -1;
+
+	for (const char* p = file.begin(); p != file.end(); skip_line(p, file.end()))
+	{
+		skip_blanks(p, file.end());
+
+		if (p == file.end() || *p == '\n' || *p == '#' || *p == '%')
+		{
+			continue;
+		}
+
+		int u = parse_int(p, file.end());
+		int v = parse_int(p, file.end());
+
+		max_label = std::max(max_label, std::max(u, v));
+		edge_list.push_back({ u, v });
+	}
+
+	return CSRGraph(max_label + 1, edge_list);
+}
+
+void write_edge_list(const CSRGraph& G, const std::string& path)
+{
+	BufferedWriter out(path);
+
+	for (int v = 0; v < G.size(); v++)
+	{
+		for (const int* j = std::upper_bound(G.begin(v), G.end(v), v); j != G.end(v); j++)
+		{
+			out.put_int(v);
+			out.put(' ');
+			out.put_int(*j);
+			out.put('\n');
+		}
+	}
+
+	out.close();
+}
+
+CSRGraph read_dimacs(const std::string& path)
+{
+	MappedFile file(path);
+
+	int n = -1;
+	vector<pair<int, int>> edge_list;
+
+	for (const char* p = file.begin(); p != file.end(); skip_line(p, file.end()))
+	{
+		skip_blanks(p, file.end());
+
+		if (p == file.end() || *p == '\n' || *p == 'c')
+		{
+			continue;
+		}
+
+		if (*p == 'p')
+		{
+			p++;
+			skip_blanks(p, file.end());
+
+			while (p != file.end() && *p >= 'a' && *p <= 'z') //the format word: edge, col, ...
+			{
+				p++;
+			}
+
+			n = parse_int(p, file.end());
+			edge_list.reserve(parse_int(p, file.end()));
+		}
+
+		else if (*p == 'e' && n >= 0)
+		{
+			p++;
+
+			int u = parse_int(p, file.end());
+			int v = parse_int(p, file.end());
+
+			if (u < 1 || u > n || v < 1 || v > n)
+			{
+				throw InvalidGraphFile();
+			}
+
+			edge_list.push_back({ u - 1, v - 1 });
+		}
+
+		else
+		{
+			throw InvalidGraphFile();
+		}
+	}
+
+	if (n < 0)
+	{
+		throw InvalidGraphFile();
+	}
+
+	return CSRGraph(n, edge_list);
+}
+
+void write_dimacs(const CSRGraph& G, const std::string& path)
+{
+	BufferedWriter out(path);
+
+	out.put("p edge ");
+	out.put_int(G.size());
+	out.put(' ');
+	out.put_int(G.edges());
+	out.put('\n');
+
+	for (int v = 0; v < G.size(); v++)
+	{
+		for (const int* j = std::upper_bound(G.begin(v), G.end(v), v); j != G.end(v); j++)
+		{
+			out.put("e ");
+			out.put_int(v + 1);
+			out.put(' ');
+			out.put_int(*j + 1);
+			out.put('\n');
+		}
+	}
+
+	out.close();
+}
+
+//graph6 and sparse6 store 6 bits per byte, each byte offset by 63 so that it is printable.
+
+static long long parse_size6(const char*& p, const char* end) //the N(n) field: one byte below 126, or 126 and 18 bits, or 126 126 and 36 bits
+{
+	int fields = 1;
+
+	if (p != end && *p == 126)
+	{
+		p++;
+		fields = 3;
+
+		if (p != end && *p == 126)
+		{
+			p++;
+			fields = 6;
+		}
+	}
+
+	long long n = 0;
+
+	for (int k = 0; k < fields; k++, p++)
+	{
+		if (p == end || *p < 63 || *p > 126)
+		{
+			throw InvalidGraphFile();
+		}
+
+		n = (n << 6) | (*p - 63);
+	}
+
+	if (n > INT32_MAX)
+	{
+		throw InvalidGraphFile();
+	}
+
+	return n;
+}
+
+static void put_size6(BufferedWriter& out, long long n)
+{
+	int fields = 1;
+
+	if (n > 258047)
+	{
+		out.put(126);
+		out.put(126);
+		fields = 6;
+	}
+
+	else if (n > 62)
+	{
+		out.put(126);
+		fields = 3;
+	}
+
+	for (int k = fields - 1; k >= 0; k--)
+	{
+		out.put((char)(63 + ((n >> (6 * k)) & 63)));
+	}
+}
+
+static CSRGraph parse_graph6(const char* p, const char* end) //bits of the upper triangle, column by column: (0,1), (0,2), (1,2), (0,3), ...
+{
+	int n = parse_size6(p, end);
+
+	vector<pair<int, int>> edge_list;
+
+	int i = 0;
+	int j = 1;
+
+	for (; p != end && j < n; p++)
+	{
+		int bits = *p - 63;
+
+		if (bits < 0 || bits > 63)
+		{
+			throw InvalidGraphFile();
+		}
+
+		if (bits == 0) //sparse graphs are mostly zero bytes; step over all six positions at once
+		{
+			i += 6;
+
+			while (i >= j && j < n)
+			{
+				i -= j;
+				j++;
+			}
+
+			continue;
+		}
+
+		for (int b = 5; b >= 0 && j < n; b--)
+		{
+			if (bits & (1 << b))
+			{
+				edge_list.push_back({ j, i });
+			}
+
+			if (++i == j)
+			{
+				i = 0;
+				j++;
+			}
+		}
+	}
+
+	if (j < n)
+	{
+		throw InvalidGraphFile();
+	}
+
+	return CSRGraph(n, edge_list);
+}
+
+static int bits_for(int n) //bits needed to write n - 1 in binary
+{
+	int k = 0;
+
+	for (int x = n - 1; x > 0; x >>= 1)
+	{
+		k++;
+	}
+
+	return k;
+}
+
+static CSRGraph parse_sparse6(const char* p, const char* end) //pairs (b, x) of 1 and k bits: b = 1 moves to the next vertex v, then x > v jumps to x and x <= v is the edge {x, v}
+{
+	int n = parse_size6(p, end);
+	int k = bits_for(n);
+
+	vector<pair<int, int>> edge_list;
+
+	int bits = 0; //current byte and how many of its bits are left
+	int left = 0;
+
+	auto next_bit = [&](int& bit)
+	{
+		if (left == 0)
+		{
+			if (p == end)
+			{
+				return false;
+			}
+
+			bits = *p++ - 63;
+			left = 6;
+
+			if (bits < 0 || bits > 63)
+			{
+				throw InvalidGraphFile();
+			}
+		}
+
+		bit = (bits >> --left) & 1;
+		return true;
+	};
+
+	long long v = 0;
+
+	while (true)
+	{
+		int b;
+
+		if (!next_bit(b))
+		{
+			break;
+		}
+
+		long long x = 0;
+		int bit;
+		int read = 0;
+
+		for (; read < k && next_bit(bit); read++)
+		{
+			x = (x << 1) | bit;
+		}
+
+		if (read < k) //padding
+		{
+			break;
+		}
+
+		if (b)
+		{
+			v++;
+		}
+
+		if (x > v)
+		{
+			v = x;
+		}
+
+		else if (v < n)
+		{
+			edge_list.push_back({ (int)v, (int)x });
+		}
+	}
+
+	return CSRGraph(n, edge_list);
+}
+
+std::vector<CSRGraph> read_graph6(const std::string& path)
+{
+	MappedFile file(path);
+
+	vector<CSRGraph> out;
+
+	for (const char* p = file.begin(); p != file.end();)
+	{
+		const char* line_end = std::find(p, file.end(), '\n');
+		const char* next = line_end == file.end() ? line_end : line_end + 1;
+
+		while (line_end != p && (line_end[-1] == '\r' || line_end[-1] == ' '))
+		{
+			line_end--;
+		}
+
+		for (const char* header : { ">>graph6<<", ">>sparse6<<" })
+		{
+			size_t len = std::char_traits<char>::length(header);
+
+			if (line_end - p >= len && std::equal(header, header + len, p))
+			{
+				p += len;
+			}
+		}
+
+		if (p != line_end)
+		{
+			if (*p == ':')
+			{
+				out.push_back(parse_sparse6(p + 1, line_end));
+			}
+
+			else
+			{
+				out.push_back(parse_graph6(p, line_end));
+			}
+		}
+
+		p = next;
+	}
+
+	return out;
+}
+
+static void put_graph6(BufferedWriter& out, const CSRGraph& G)
+{
+	long long n = G.size();
+
+	put_size6(out, n);
+
+	long long total_bytes = (n * (n - 1) / 2 + 5) / 6;
+	long long byte = 0; //index of the byte being filled
+	int bits = 0;
+
+	for (int j = 1; j < n; j++) //the set bits come in increasing position, so the bytes between them are streamed out as zeros
+	{
+		for (const int* i = G.begin(j); i != G.end(j) && *i < j; i++)
+		{
+			long long pos = (long long)j * (j - 1) / 2 + *i;
+
+			for (; byte < pos / 6; byte++)
+			{
+				out.put((char)(63 + bits));
+				bits = 0;
+			}
+
+			bits |= 1 << (5 - pos % 6);
+		}
+	}
+
+	for (; byte < total_bytes; byte++)
+	{
+		out.put((char)(63 + bits));
+		bits = 0;
+	}
+
+	out.put('\n');
+}
+
+static void put_sparse6(BufferedWriter& out, const CSRGraph& G) //the encoder of nauty's ntos6, padding included
+{
+	int n = G.size();
+	int k = bits_for(n);
+
+	out.put(':');
+	put_size6(out, n);
+
+	int bits = 0;
+	int free_bits = 6;
+
+	auto put_bits = [&](long long x, int count)
+	{
+		for (int r = count - 1; r >= 0; r--)
+		{
+			bits = (bits << 1) | ((x >> r) & 1);
+
+			if (--free_bits == 0)
+			{
+				out.put((char)(63 + bits));
+				bits = 0;
+				free_bits = 6;
+			}
+		}
+	};
+
+	int last_v = 0;
+
+	for (int v = 0; v < n; v++)
+	{
+		for (const int* u = G.begin(v); u != G.end(v) && *u < v; u++)
+		{
+			if (v == last_v)
+			{
+				put_bits(0, 1);
+			}
+
+			else
+			{
+				put_bits(1, 1);
+
+				if (v > last_v + 1)
+				{
+					put_bits(v, k);
+					put_bits(0, 1);
+				}
+
+				last_v = v;
+			}
+
+			put_bits(*u, k);
+		}
+	}
+
+	if (free_bits != 6)
+	{
+		if (free_bits >= k + 1 && last_v == n - 2 && n == (1LL << k)) //plain 1 padding would read as the edge {n-1, n-1} here
+		{
+			bits = (bits << free_bits) | ((1 << (free_bits - 1)) - 1);
+		}
+
+		else
+		{
+			bits = (bits << free_bits) | ((1 << free_bits) - 1);
+		}
+
+		out.put((char)(63 + bits));
+	}
+
+	out.put('\n');
+}
+
+void write_graph6(const CSRGraph& G, const std::string& path)
+{
+	BufferedWriter out(path);
+
+	put_graph6(out, G);
+
+	out.close();
+}
+
+void write_graph6(const std::vector<CSRGraph>& graphs, const std::string& path)
+{
+	BufferedWriter out(path);
+
+	for (const CSRGraph& G : graphs)
+	{
+		put_graph6(out, G);
+	}
+
+	out.close();
+}
+
+void write_sparse6(const CSRGraph& G, const std::string& path)
+{
+	BufferedWriter out(path);
+
+	put_sparse6(out, G);
+
+	out.close();
+}
+
+void write_sparse6(const std::vector<CSRGraph>& graphs, const std::string& path)
+{
+	BufferedWriter out(path);
+
+	for (const CSRGraph& G : graphs)
+	{
+		put_sparse6(out, G);
+	}
+
+	out.close();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <exception>
+
+#include "CSRGraph.h"
+
+//Readers map the whole file into memory and parse it in place; writers fill one large buffer and write it out in blocks.
+//Vertices are 0-based in memory. A Graph can be passed to any writer through the CSRGraph(const Graph&) conversion.
+
+CSRGraph read_edge_list(const std::string& path); //one "u v" pair per line with 0-based labels; anything after the pair is ignored; lines starting with # or % are comments; the vertex count is one more than the largest label
+void write_edge_list(const CSRGraph& G, const std::string& path); //each edge once, as "u v" with u < v
+
+CSRGraph read_dimacs(const std::string& path); //"p edge n m" header, then "e u v" lines with 1-based labels; "c" lines are comments
+void write_dimacs(const CSRGraph& G, const std::string& path);
+
+std::vector<CSRGraph> read_graph6(const std::string& path); //one graph per line, in graph6 or sparse6 (lines starting with ':'); >>graph6<< and >>sparse6<< headers are skipped
+void write_graph6(const CSRGraph& G, const std::string& path);
+void write_graph6(const std::vector<CSRGraph>& graphs, const std::string& path); //one graph per line
+void write_sparse6(const CSRGraph& G, const std::string& path);
+void write_sparse6(const std::vector<CSRGraph>& graphs, const std::string& path);
+
+class InvalidGraphFile : public std::exception
+{
+public:
+
+	virtual char const* what() const throw()
+	{
+		return "Graph file could not be opened, written or parsed";
+	}
+};
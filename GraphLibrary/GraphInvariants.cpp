@@ -0,0 +1,315 @@
+#include "GraphInvariants.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
+using std::vector;
+
+//Multisets are hashed as the sum of a mixed hash of each element, which does not depend on the order the elements come in, and so not on the labels.
+
+static uint64_t mix(uint64_t x) //splitmix64 finalizer
+{
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+
+	return x ^ (x >> 31);
+}
+
+static uint64_t combine(uint64_t h, uint64_t x) //order-dependent
+{
+	return mix(h ^ mix(x));
+}
+
+static uint64_t degree_hash(const CSRGraph& G)
+{
+	uint64_t h = 0;
+
+	for (int v = 0; v < G.size(); v++)
+	{
+		h += mix(G.degree(v));
+	}
+
+	return h;
+}
+
+static uint64_t refinement_hash(const CSRGraph& G, int rounds)
+{
+	int n = G.size();
+
+	vector<uint64_t> color(n);
+	vector<uint64_t> next(n);
+
+	for (int v = 0; v < n; v++)
+	{
+		color[v] = mix(G.degree(v));
+	}
+
+	uint64_t h = 0;
+
+	for (int r = 0; r < rounds; r++)
+	{
+		uint64_t histogram = 0;
+
+		for (int v = 0; v < n; v++)
+		{
+			uint64_t seen = 0; //multiset of neighbor colors
+
+			for (const int* j = G.begin(v); j != G.end(v); j++)
+			{
+				seen += mix(color[*j] ^ 0x5bd1e9955bd1e995ULL);
+			}
+
+			next[v] = combine(color[v], seen);
+			histogram += mix(next[v]);
+		}
+
+		color.swap(next);
+		h = combine(h, histogram);
+	}
+
+	return h;
+}
+
+static uint64_t triangle_hash(const CSRGraph& G) //each edge is kept only from its end of lower (degree, label) rank, so each triangle is found once, from its lowest vertex
+{
+	int n = G.size();
+
+	auto before = [&](int a, int b) { return G.degree(a) < G.degree(b) || (G.degree(a) == G.degree(b) && a < b); };
+
+	vector<int> offsets(n + 1, 0);
+	vector<int> out;
+
+	out.reserve(G.edges());
+
+	for (int v = 0; v < n; v++)
+	{
+		for (const int* j = G.begin(v); j != G.end(v); j++)
+		{
+			if (before(v, *j))
+			{
+				out.push_back(*j);
+			}
+		}
+
+		offsets[v + 1] = out.size();
+	}
+
+	vector<long long> triangles(n, 0);
+	vector<int> mark(n, -1);
+
+	for (int v = 0; v < n; v++)
+	{
+		for (int k = offsets[v]; k < offsets[v + 1]; k++)
+		{
+			mark[out[k]] = v;
+		}
+
+		for (int k = offsets[v]; k < offsets[v + 1]; k++)
+		{
+			int u = out[k];
+
+			for (int l = offsets[u]; l < offsets[u + 1]; l++)
+			{
+				int w = out[l];
+
+				if (mark[w] == v)
+				{
+					triangles[v]++;
+					triangles[u]++;
+					triangles[w]++;
+				}
+			}
+		}
+	}
+
+	uint64_t h = 0;
+
+	for (int v = 0; v < n; v++)
+	{
+		h += mix(combine(G.degree(v), triangles[v]));
+	}
+
+	return h;
+}
+
+static uint64_t distance_hash(const CSRGraph& G)
+{
+	int n = G.size();
+
+	vector<int> dist(n, -1);
+	vector<int> queue(n);
+	vector<int> histogram;
+
+	uint64_t h = 0;
+
+	for (int s = 0; s < n; s++)
+	{
+		int head = 0;
+		int tail = 0;
+
+		queue[tail++] = s;
+		dist[s] = 0;
+		histogram.assign(1, 1);
+
+		while (head < tail)
+		{
+			int v = queue[head++];
+
+			for (const int* j = G.begin(v); j != G.end(v); j++)
+			{
+				if (dist[*j] == -1)
+				{
+					dist[*j] = dist[v] + 1;
+					queue[tail++] = *j;
+
+					if (dist[*j] == histogram.size())
+					{
+						histogram.push_back(0);
+					}
+
+					histogram[dist[*j]]++;
+				}
+			}
+		}
+
+		uint64_t vertex = n - tail; //unreachable vertices, then the number at each distance
+
+		for (int count : histogram)
+		{
+			vertex = combine(vertex, count);
+		}
+
+		h += mix(vertex);
+
+		for (int k = 0; k < tail; k++)
+		{
+			dist[queue[k]] = -1;
+		}
+	}
+
+	return h;
+}
+
+uint64_t GraphInvariants::combined() const
+{
+	uint64_t h = combine(vertices, edges);
+
+	h = combine(h, degrees);
+	h = combine(h, refinement);
+	h = combine(h, triangles);
+
+	return combine(h, distances);
+}
+
+bool operator==(const GraphInvariants& a, const GraphInvariants& b)
+{
+	return a.vertices == b.vertices && a.edges == b.edges && a.degrees == b.degrees && a.refinement == b.refinement && a.triangles == b.triangles && a.distances == b.distances;
+}
+
+bool operator!=(const GraphInvariants& a, const GraphInvariants& b)
+{
+	return !(a == b);
+}
+
+GraphInvariants graph_invariants(const CSRGraph& G, const InvariantOptions& options)
+{
+	GraphInvariants out;
+
+	out.vertices = G.size();
+	out.edges = G.edges();
+	out.degrees = degree_hash(G);
+	out.refinement = options.refinement_rounds > 0 ? refinement_hash(G, options.refinement_rounds) : 0;
+	out.triangles = options.triangles ? triangle_hash(G) : 0;
+	out.distances = options.distances ? distance_hash(G) : 0;
+
+	return out;
+}
+
+GraphInvariants graph_invariants(const Graph& G, const InvariantOptions& options)
+{
+	return graph_invariants(CSRGraph(G), options);
+}
+
+template<class T>
+static vector<GraphInvariants> batch_invariants(const vector<T>& graphs, const InvariantOptions& options, int threads)
+{
+	if (threads <= 0)
+	{
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	int count = graphs.size();
+
+	vector<GraphInvariants> out(count);
+	std::atomic<int> next_graph(0);
+
+	auto worker = [&]()
+	{
+		for (int k = next_graph++; k < count; k = next_graph++)
+		{
+			out[k] = graph_invariants(graphs[k], options);
+		}
+	};
+
+	vector<std::thread> pool;
+
+	for (int t = 1; t < std::min(threads, count); t++)
+	{
+		pool.emplace_back(worker);
+	}
+
+	worker();
+
+	for (auto& t : pool)
+	{
+		t.join();
+	}
+
+	return out;
+}
+
+std::vector<GraphInvariants> graph_invariants(const std::vector<CSRGraph>& graphs, const InvariantOptions& options, int threads)
+{
+	return batch_invariants(graphs, options, threads);
+}
+
+std::vector<GraphInvariants> graph_invariants(const std::vector<Graph>& graphs, const InvariantOptions& options, int threads)
+{
+	return batch_invariants(graphs, options, threads);
+}
+
+std::vector<std::vector<int>> invariant_classes(const std::vector<GraphInvariants>& invariants)
+{
+	vector<vector<int>> classes;
+	std::unordered_map<uint64_t, vector<int>> by_hash; //indices into classes with each combined hash
+
+	for (int k = 0; k < invariants.size(); k++)
+	{
+		vector<int>& candidates = by_hash[invariants[k].combined()];
+
+		int found = -1;
+
+		for (int c : candidates)
+		{
+			if (invariants[classes[c][0]] == invariants[k])
+			{
+				found = c;
+				break;
+			}
+		}
+
+		if (found == -1)
+		{
+			found = classes.size();
+			candidates.push_back(found);
+			classes.emplace_back();
+		}
+
+		classes[found].push_back(k);
+	}
+
+	return classes;
+}
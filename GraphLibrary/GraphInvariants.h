@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "Graph.h"
+#include "CSRGraph.h"
+
+struct InvariantOptions //which invariants to compute; stronger ones separate more graphs and cost more
+{
+	int refinement_rounds = 3; //rounds of 1-WL color refinement whose color histograms are hashed, O(n + m) each; 0 skips them
+	bool triangles = false; //number of triangles at each vertex, with its degree; O(m^1.5)
+	bool distances = false; //histogram of BFS distances from each vertex; O(n (n + m))
+};
+
+struct GraphInvariants //hashes of isomorphism invariants: graphs with different invariants are not isomorphic, graphs with equal ones may still not be
+{
+	int vertices;
+	int edges;
+
+	uint64_t degrees; //degree sequence
+	uint64_t refinement; //color histogram after each round; the rest are 0 when not asked for
+	uint64_t triangles;
+	uint64_t distances;
+
+	uint64_t combined() const; //all of the above in one word, e.g. for a hash table
+};
+
+bool operator==(const GraphInvariants& a, const GraphInvariants& b); //only meaningful between invariants computed with the same options
+bool operator!=(const GraphInvariants& a, const GraphInvariants& b);
+
+GraphInvariants graph_invariants(const CSRGraph& G, const InvariantOptions& options = InvariantOptions());
+GraphInvariants graph_invariants(const Graph& G, const InvariantOptions& options = InvariantOptions());
+
+//Batches: one graph at a time per thread, results in input order; threads = 0 uses every hardware thread.
+std::vector<GraphInvariants> graph_invariants(const std::vector<CSRGraph>& graphs, const InvariantOptions& options = InvariantOptions(), int threads = 0);
+std::vector<GraphInvariants> graph_invariants(const std::vector<Graph>& graphs, const InvariantOptions& options = InvariantOptions(), int threads = 0);
+
+std::vector<std::vector<int>> invariant_classes(const std::vector<GraphInvariants>& invariants); //indices grouped by equal invariants, groups in order of their first index; only graphs in the same group can be isomorphic
@@ -0,0 +1,125 @@
+#include "BlockSystem.h"
+
+#include <iostream>
+
+using std::vector;
+using std::set;
+
+BlockSystem::BlockSystem(const std::vector<int>& labels) :
+	block_of(labels.size(), -1),
+	offsets({ 0 })
+{
+	vector<int> renumbered(labels.size() + 1, -1); //a label is at most labels.size() if every point gets its own
+	vector<int> counts;
+
+	for (int p = 0; p < labels.size(); p++)
+	{
+		if (labels[p] < 0)
+		{
+			continue;
+		}
+
+		if (labels[p] >= renumbered.size())
+		{
+			renumbered.resize(labels[p] + 1, -1);
+		}
+
+		if (renumbered[labels[p]] == -1)
+		{
+			renumbered[labels[p]] = counts.size();
+			counts.push_back(0);
+		}
+
+		block_of[p] = renumbered[labels[p]];
+		counts[block_of[p]]++;
+	}
+
+	for (int b = 0; b < counts.size(); b++)
+	{
+		offsets.push_back(offsets.back() + counts[b]);
+	}
+
+	members.resize(offsets.back());
+
+	vector<int> next(offsets.begin(), offsets.end() - 1);
+
+	for (int p = 0; p < block_of.size(); p++) //points in increasing order, so each block comes out sorted
+	{
+		if (block_of[p] != -1)
+		{
+			members[next[block_of[p]]++] = p;
+		}
+	}
+}
+
+BlockSystem::BlockSystem(const std::vector<std::set<int>>& B, int n) :
+	block_of(n, -1),
+	offsets({ 0 })
+{
+	for (int b = 0; b < B.size(); b++)
+	{
+		if (B[b].empty())
+		{
+			throw InvalidBlockSystem();
+		}
+
+		for (int p : B[b])
+		{
+			if (p < 0 || p >= n || block_of[p] != -1)
+			{
+				throw InvalidBlockSystem();
+			}
+
+			block_of[p] = b;
+			members.push_back(p);
+		}
+
+		offsets.push_back(members.size());
+	}
+}
+
+std::set<int> BlockSystem::block_set(int b) const
+{
+	return set<int>(begin(b), end(b));
+}
+
+std::vector<std::set<int>> BlockSystem::to_sets() const
+{
+	vector<set<int>> out;
+
+	for (int b = 0; b < size(); b++)
+	{
+		out.push_back(block_set(b));
+	}
+
+	return out;
+}
+
+void BlockSystem::print() const
+{
+	std::cout << "{ ";
+
+	for (int b = 0; b < size(); b++)
+	{
+		std::cout << "{";
+
+		for (const int* p = begin(b); p != end(b); p++)
+		{
+			std::cout << " " << *p;
+		}
+
+		std::cout << " } ";
+	}
+
+	std::cout << "}";
+}
+
+bool operator==(const BlockSystem& A, const BlockSystem& B)
+{
+	return A.labels() == B.labels();
+}
+
+bool operator<(const BlockSystem& A, const BlockSystem& B)
+{
+	return A.labels() < B.labels();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <set>
+#include <exception>
+
+class BlockSystem //disjoint blocks of points of {0, ... , n-1}, stored flat; usually a partition of all of them
+{
+
+private:
+
+	std::vector<int> block_of; //block_of[p] = index of the block containing p, or -1 if p is in no block
+	std::vector<int> offsets; //block b is members[offsets[b]], ... , members[offsets[b+1]-1], in increasing order
+	std::vector<int> members;
+
+public:
+
+	BlockSystem(const std::vector<int>& labels); //labels[p] = label of the block containing p, or -1; blocks are renumbered 0, 1, ... in order of their smallest point
+	BlockSystem(const std::vector<std::set<int>>& B, int n); //blocks keep their order in B; throws InvalidBlockSystem unless they are disjoint, non-empty subsets of {0, ... , n-1}
+
+	int degree() const { return block_of.size(); }
+	int size() const { return offsets.size() - 1; } //number of blocks
+
+	int block(int p) const { return block_of[p]; }
+	int block_size(int b) const { return offsets[b + 1] - offsets[b]; }
+	int first(int b) const { return members[offsets[b]]; } //smallest point of block b
+
+	const int* begin(int b) const { return members.data() + offsets[b]; }
+	const int* end(int b) const { return members.data() + offsets[b + 1]; }
+
+	const std::vector<int>& labels() const { return block_of; }
+
+	std::set<int> block_set(int b) const;
+	std::vector<std::set<int>> to_sets() const;
+
+	void print() const;
+};
+
+bool operator==(const BlockSystem& A, const BlockSystem& B); //same blocks, numbered the same way
+bool operator<(const BlockSystem& A, const BlockSystem& B);
+
+class InvalidBlockSystem : public std::exception
+{
+public:
+
+	virtual char const* what() const throw()
+	{
+		return "Invalid block system";
+	}
+};
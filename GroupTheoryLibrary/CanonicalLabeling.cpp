@@ -0,0 +1,424 @@
+#include "CanonicalLabeling.h"
+
+#include <algorithm>
+
+using std::vector;
+
+CanonicalLabeling::CanonicalLabeling(const CSRGraph& G, const std::vector<int>& vertex_colors) :
+	n(G.size()),
+	graph(G),
+	colors(vertex_colors),
+	refiner(graph),
+	first_orbits(G.size()),
+	smallest(G.size()),
+	nodes(0)
+{
+	if (!colors.empty() && colors.size() != n)
+	{
+		throw InvalidPermOperation();
+	}
+
+	for (int v = 0; v < n; v++)
+	{
+		smallest[v] = v;
+	}
+
+	OrderedPartition root(colors.empty() ? vector<int>(n, 0) : colors);
+
+	refiner.refine(root);
+
+	search(root);
+}
+
+bool CanonicalLabeling::fixes_path(const Permutation& g, const std::vector<int>& points, int depth) const
+{
+	for (int i = 0; i < depth; i++)
+	{
+		if (g[points[i]] != points[i])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void CanonicalLabeling::merge_pending(int depth)
+{
+	int kept = 0;
+
+	for (int i : pending)
+	{
+		const Permutation& g = automorphisms[i];
+
+		if (!fixes_path(g, first_path, depth))
+		{
+			pending[kept++] = i; //may still fix a shorter prefix higher up
+			continue;
+		}
+
+		for (int v = 0; v < n; v++)
+		{
+			int a = first_orbits.find(v);
+			int b = first_orbits.find(g[v]);
+
+			if (first_orbits.unite(a, b) != -1)
+			{
+				smallest[first_orbits.find(a)] = std::min(smallest[a], smallest[b]);
+			}
+		}
+	}
+
+	pending.resize(kept);
+}
+
+unsigned long long CanonicalLabeling::invariant(const OrderedPartition& P, int mark)
+{
+	unsigned long long h = 14695981039346656037ULL; //FNV-1a
+
+	for (int i = mark; i < P.splits().size(); i++)
+	{
+		h = (h ^ (unsigned long long)P.splits()[i].first) * 1099511628211ULL;
+		h = (h ^ (unsigned long long)P.splits()[i].second) * 1099511628211ULL;
+	}
+
+	return h;
+}
+
+void CanonicalLabeling::push_trace(unsigned long long h)
+{
+	int d = trace.size();
+
+	trace.push_back(h);
+
+	if (first_order.empty())
+	{
+		agrees_first.push_back(true);
+		versus_best.push_back(0);
+		return;
+	}
+
+	agrees_first.push_back((d == 0 || agrees_first[d - 1]) && d < first_trace.size() && first_trace[d] == h);
+
+	if (d > 0 && versus_best[d - 1] != 0)
+	{
+		versus_best.push_back(versus_best[d - 1]);
+	}
+
+	else
+	{
+		versus_best.push_back(d >= best_trace.size() || h > best_trace[d] ? 1 : (h < best_trace[d] ? -1 : 0));
+	}
+}
+
+void CanonicalLabeling::pop_trace()
+{
+	trace.pop_back();
+	agrees_first.pop_back();
+	versus_best.pop_back();
+}
+
+void CanonicalLabeling::compare_trace()
+{
+	vector<unsigned long long> current;
+
+	current.swap(trace);
+	agrees_first.clear();
+	versus_best.clear();
+
+	for (unsigned long long h : current)
+	{
+		push_trace(h);
+	}
+}
+
+int CanonicalLabeling::common_prefix(const std::vector<int>& a, const std::vector<int>& b)
+{
+	return std::mismatch(a.begin(), a.begin() + std::min(a.size(), b.size()), b.begin()).first - a.begin();
+}
+
+std::vector<int> CanonicalLabeling::leaf_certificate(const std::vector<int>& order) const
+{
+	vector<int> label(n);
+
+	for (int k = 0; k < n; k++)
+	{
+		label[order[k]] = k;
+	}
+
+	vector<int> out;
+	out.reserve(n + 1 + graph.neighbor_array().size() + colors.size());
+
+	out.push_back(0);
+
+	for (int k = 0; k < n; k++)
+	{
+		out.push_back(out.back() + graph.degree(order[k]));
+	}
+
+	for (int k = 0; k < n; k++)
+	{
+		size_t start = out.size();
+
+		for (const int* j = graph.begin(order[k]); j != graph.end(order[k]); j++)
+		{
+			out.push_back(label[*j]);
+		}
+
+		std::sort(out.begin() + start, out.end());
+	}
+
+	for (int k = 0; k < colors.size(); k++)
+	{
+		out.push_back(colors[order[k]]);
+	}
+
+	return out;
+}
+
+int CanonicalLabeling::leaf(const OrderedPartition& P)
+{
+	int depth = path.size();
+
+	vector<int> certificate = leaf_certificate(P.vertex_order());
+
+	if (first_order.empty())
+	{
+		first_order = best_order = P.vertex_order();
+		first_path = best_path = path;
+		first_trace = best_trace = trace;
+		first_certificate = best_certificate = certificate;
+
+		compare_trace();
+
+		return depth;
+	}
+
+	if (trace == first_trace && certificate == first_certificate) //first_order[k] -> order[k] preserves edges and colors
+	{
+		vector<int> values(n);
+
+		for (int k = 0; k < n; k++)
+		{
+			values[first_order[k]] = P.vertex_order()[k];
+		}
+
+		pending.push_back(automorphisms.size());
+		automorphisms.push_back(Permutation(values));
+
+		return common_prefix(path, first_path); //it carries the first path's subtree at the divergence onto this one, so the rest of this one adds nothing
+	}
+
+	if (trace == best_trace && certificate == best_certificate)
+	{
+		vector<int> values(n);
+
+		for (int k = 0; k < n; k++)
+		{
+			values[best_order[k]] = P.vertex_order()[k];
+		}
+
+		pending.push_back(automorphisms.size());
+		automorphisms.push_back(Permutation(values));
+
+		return common_prefix(path, best_path);
+	}
+
+	if (trace < best_trace || (trace == best_trace && certificate < best_certificate))
+	{
+		best_order = P.vertex_order();
+		best_path = path;
+		best_trace = trace;
+		best_certificate = std::move(certificate);
+
+		compare_trace();
+	}
+
+	return depth;
+}
+
+int CanonicalLabeling::next_child(SearchFrame& frame, const OrderedPartition& P, int depth)
+{
+	if (frame.on_first) //visits children in increasing order, skipping any which an automorphism fixing the path carries onto a smaller one
+	{
+		if (!first_order.empty())
+		{
+			merge_pending(depth);
+		}
+
+		int child = -1;
+
+		for (const int* v = P.begin(frame.target); v != P.end(frame.target); v++)
+		{
+			if (*v > frame.last && (child == -1 || *v < child) && (first_order.empty() || smallest[first_orbits.find(*v)] == *v))
+			{
+				child = *v;
+			}
+		}
+
+		return frame.last = child;
+	}
+
+	if (frame.last == -1) //the first child is taken as it stands, since most nodes off the first path are abandoned after one leaf
+	{
+		return frame.last = *P.begin(frame.target);
+	}
+
+	if (frame.next == 0 && frame.rest.empty())
+	{
+		for (const int* v = P.begin(frame.target); v != P.end(frame.target); v++)
+		{
+			if (*v != frame.last)
+			{
+				frame.rest.push_back(*v);
+			}
+		}
+
+		std::sort(frame.rest.begin(), frame.rest.end());
+	}
+
+	return frame.next < frame.rest.size() ? frame.rest[frame.next++] : -1;
+}
+
+void CanonicalLabeling::search(OrderedPartition& P) //iterative, since the search can be as deep as the graph is large
+{
+	vector<SearchFrame> stack;
+
+	nodes++;
+	push_trace(invariant(P, 0));
+
+	if (P.is_discrete())
+	{
+		leaf(P);
+		return;
+	}
+
+	auto open = [&](int target, bool on_first) //pushes a frame for the current node, whose first nontrivial cell is at or after target
+	{
+		while (P.cell_size(target) == 1)
+		{
+			target = P.next_cell(target);
+		}
+
+		SearchFrame frame;
+
+		frame.target = target;
+		frame.last = -1;
+		frame.next = 0;
+		frame.mark = 0;
+		frame.on_first = on_first;
+
+		stack.push_back(std::move(frame));
+	};
+
+	auto close_child = [&]() //returns from the current child of the top frame
+	{
+		pop_trace();
+		path.pop_back();
+		P.restore(stack.back().mark);
+	};
+
+	open(0, true);
+
+	int resume = n; //depth the search is unwinding to, or n if it is not unwinding
+
+	while (!stack.empty())
+	{
+		int depth = stack.size() - 1;
+		SearchFrame& frame = stack.back();
+
+		int w = resume < depth ? -1 : next_child(frame, P, depth);
+
+		if (w == -1) //abandoned or finished
+		{
+			stack.pop_back();
+
+			if (!stack.empty())
+			{
+				close_child();
+			}
+
+			continue;
+		}
+
+		resume = n;
+
+		bool child_on_first = frame.on_first && (first_order.empty() || w == first_path[depth]);
+		int target = frame.target;
+
+		frame.mark = P.checkpoint();
+		refiner.individualize(P, w);
+		path.push_back(w);
+		push_trace(invariant(P, frame.mark));
+		nodes++;
+
+		if (!agrees_first.back() && versus_best.back() > 0) //every leaf below orders after the best leaf and none can match the first
+		{
+			close_child();
+			continue;
+		}
+
+		if (P.is_discrete())
+		{
+			int back = leaf(P);
+
+			close_child();
+
+			if (back < depth + 1)
+			{
+				resume = back;
+			}
+
+			continue;
+		}
+
+		open(target, child_on_first);
+	}
+}
+
+Permutation CanonicalLabeling::labeling() const
+{
+	vector<int> values(n);
+
+	for (int k = 0; k < n; k++)
+	{
+		values[best_order[k]] = k;
+	}
+
+	return Permutation(values);
+}
+
+Graph CanonicalLabeling::canonical_graph() const
+{
+	return labeling()[graph.to_graph()];
+}
+
+CSRGraph CanonicalLabeling::canonical_csr() const
+{
+	return labeling()[graph];
+}
+
+PermGroup CanonicalLabeling::automorphism_group() const
+{
+	if (automorphisms.empty())
+	{
+		return PermGroup(n);
+	}
+
+	return PermGroup(automorphisms, TransversalStorage::schreier_vectors); //automorphism groups have large degree and small order, where explicit transversals cost n^2 per level
+}
+
+bool CanonicalLabeling::isomorphic(const CSRGraph& G, const CSRGraph& H)
+{
+	return isomorphic(G, {}, H, {});
+}
+
+bool CanonicalLabeling::isomorphic(const CSRGraph& G, const std::vector<int>& G_colors, const CSRGraph& H, const std::vector<int>& H_colors)
+{
+	if (G.size() != H.size() || G.edges() != H.edges() || G_colors.size() != H_colors.size())
+	{
+		return false;
+	}
+
+	return CanonicalLabeling(G, G_colors).certificate() == CanonicalLabeling(H, H_colors).certificate();
+}
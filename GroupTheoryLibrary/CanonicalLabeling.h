@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+
+#include "Permutation.h"
+#include "PermGroup.h"
+
+#include "GraphLibrary/Graph.h"
+#include "GraphLibrary/CSRGraph.h"
+#include "GraphLibrary/ColorRefinement.h"
+#include "GraphLibrary/DisjointSets.h"
+
+class CanonicalLabeling //canonical form and automorphism group of a vertex-colored graph by individualization-refinement (McKay): a depth first search over individualized vertices, each node refined to an equitable partition, each leaf a discrete one
+{
+
+private:
+
+	int n;
+
+	CSRGraph graph;
+	std::vector<int> colors; //empty if the graph is uncolored
+
+	ColorRefinement refiner; //refers to graph
+
+	std::vector<int> path; //vertices individualized at the current node, in order
+	std::vector<unsigned long long> trace; //invariant of every node on the current path; leaves are ordered by trace first, then by certificate
+
+	std::vector<int> first_order; //vertex order of the first leaf; automorphisms come from leaves equivalent to it
+	std::vector<int> first_path;
+	std::vector<unsigned long long> first_trace;
+	std::vector<int> first_certificate;
+
+	std::vector<int> best_order; //vertex order of the least leaf so far, the canonical one once the search ends
+	std::vector<int> best_path;
+	std::vector<unsigned long long> best_trace;
+	std::vector<int> best_certificate;
+
+	std::vector<Permutation> automorphisms;
+	std::vector<int> pending; //indices of automorphisms not yet merged into first_orbits
+
+	DisjointSets first_orbits; //orbits of the automorphisms fixing the first path down to the first path node being searched; they only grow as the search moves up that path
+	std::vector<int> smallest; //smallest[r] = least point of the orbit with representative r
+
+	long long nodes;
+
+	std::vector<char> agrees_first; //agrees_first[d] = trace[0], ... , trace[d] agree with first_trace
+	std::vector<int> versus_best; //versus_best[d] = -1, 0 or 1 as trace[0], ... , trace[d] orders before, as a prefix of, or after best_trace
+
+	struct SearchFrame //an interior node of the search whose children are being visited
+	{
+		int target; //start of the target cell; every earlier cell is a singleton
+		int last; //child visited last, or -1
+		std::vector<int> rest; //off the first path: the children after the first, in increasing order, listed once the second is needed
+		int next; //index into rest
+		int mark; //partition checkpoint from before the current child was individualized
+		bool on_first; //the node lies on the first path
+	};
+
+	int next_child(SearchFrame& frame, const OrderedPartition& P, int depth); //-1 once every child needed has been visited
+	void push_trace(unsigned long long h);
+	void pop_trace();
+	void compare_trace(); //recomputes agrees_first and versus_best after the first or best leaf changes
+
+	void search(OrderedPartition& root);
+	int leaf(const OrderedPartition& P); //returns the depth to resume at: the current one, or less to abandon every node below that depth
+	void merge_pending(int depth); //merges the pending automorphisms which fix first_path[0], ... , first_path[depth-1] into first_orbits
+	bool fixes_path(const Permutation& g, const std::vector<int>& points, int depth) const; //g fixes points[0], ... , points[depth-1]
+
+	std::vector<int> leaf_certificate(const std::vector<int>& order) const; //the graph relabeled so that order[k] becomes k, in CSR form, followed by the colors in the new order
+
+	static unsigned long long invariant(const OrderedPartition& P, int mark); //hash of the splits made since mark; splits happen in an order independent of labels
+	static int common_prefix(const std::vector<int>& a, const std::vector<int>& b);
+
+public:
+
+	CanonicalLabeling(const CSRGraph& G, const std::vector<int>& vertex_colors = {}); //vertex_colors[v] = color of v; only equal colors may be exchanged, and the canonical form lists colors in increasing order
+
+	Permutation labeling() const; //v is relabeled labeling()[v] in the canonical form
+	Graph canonical_graph() const; //labeling()[G]; equal for two graphs exactly when they are isomorphic
+	CSRGraph canonical_csr() const;
+
+	const std::vector<int>& certificate() const { return best_certificate; } //canonical form as one array, colors included; suitable as a hash key
+
+	const std::vector<Permutation>& automorphism_generators() const { return automorphisms; } //generate Aut(G)
+	PermGroup automorphism_group() const; //stores its chain as Schreier vectors
+
+	long long search_nodes() const { return nodes; }
+
+	static bool isomorphic(const CSRGraph& G, const CSRGraph& H);
+	static bool isomorphic(const CSRGraph& G, const std::vector<int>& G_colors, const CSRGraph& H, const std::vector<int>& H_colors); //by isomorphisms preserving colors
+};
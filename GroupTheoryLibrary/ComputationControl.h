@@ -0,0 +1,22 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+
+enum class ComputationStatus
+{
+	completed,
+	cancelled, //ComputationControl::cancel was set
+	out_of_budget //time_budget or work_budget ran out
+};
+
+struct ComputationControl //bounds a long computation and makes it restartable; pass the same object to the matching resume call
+{
+	std::string checkpoint_path; //empty for no checkpoints; otherwise rewritten every checkpoint_interval seconds, and once more if the computation stops early
+	double checkpoint_interval = 60;
+
+	double time_budget = 0; //seconds; 0 for unlimited
+	long long work_budget = 0; //number of sifts; 0 for unlimited
+
+	std::atomic<bool> cancel{ false }; //may be set from another thread; the computation stops before its next sift
+};
@@ -0,0 +1,116 @@
+#include "CosetTable.h"
+
+using std::vector;
+
+CosetTable::CosetTable(const PermGroup& G, const PermGroup& H) :
+	G(G),
+	H(H),
+	expanded(0)
+{
+	if (this->G.degree() != this->H.degree())
+	{
+		throw InvalidGroupOperation();
+	}
+
+	const vector<Permutation>& H_gens = this->H.get_generators();
+
+	for (int i = 0; i < H_gens.size(); i++)
+	{
+		if (!this->G.contains(H_gens[i]))
+		{
+			throw InvalidGroupOperation();
+		}
+	}
+
+	this->H.use_standard_base(); //canonical_rep minimizes over the base 0, 1, ... , n-1
+
+	if (!this->H.has_chain())
+	{
+		this->H.fast_schreier_sims();
+	}
+
+	find_or_add(Permutation(this->H.n));
+}
+
+Permutation CosetTable::canonical_rep(const Permutation& g)
+{
+	return H.min_coset_rep(g);
+}
+
+int CosetTable::find_or_add(const Permutation& rep)
+{
+	auto found = coset_ids.find(rep);
+
+	if (found != coset_ids.end())
+	{
+		return found->second;
+	}
+
+	int id = representatives.size();
+
+	coset_ids[rep] = id;
+	representatives.push_back(rep);
+
+	return id;
+}
+
+bool CosetTable::expand_next()
+{
+	if (expanded == representatives.size())
+	{
+		return false;
+	}
+
+	const vector<Permutation>& G_gens = G.get_generators();
+
+	for (int j = 0; j < G_gens.size(); j++)
+	{
+		find_or_add(canonical_rep(G_gens[j] * representatives[expanded]));
+	}
+
+	expanded++;
+
+	return true;
+}
+
+int CosetTable::coset_id(const Permutation& g)
+{
+	if (!G.contains(g))
+	{
+		throw InvalidGroupOperation();
+	}
+
+	return find_or_add(canonical_rep(g));
+}
+
+bool CosetTable::same_coset(const Permutation& g, const Permutation& h)
+{
+	return canonical_rep(g) == canonical_rep(h);
+}
+
+Permutation CosetTable::representative(int id)
+{
+	while (id >= representatives.size())
+	{
+		if (!expand_next())
+		{
+			throw InvalidGroupOperation();
+		}
+	}
+
+	return representatives[id];
+}
+
+vector<Permutation> CosetTable::transversal()
+{
+	while (expand_next());
+
+	return representatives;
+}
+
+int CosetTable::index()
+{
+	while (expand_next());
+
+	return representatives.size();
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <map>
+
+#include "Permutation.h"
+#include "PermGroup.h"
+
+class CosetTable //left cosets gH of a subgroup H of G, numbered 0,1,... in order of discovery; the coset H itself is 0
+{
+
+private:
+
+	PermGroup G;
+	PermGroup H;
+
+	std::map<Permutation, int> coset_ids; //canonical representative -> coset id
+	std::vector<Permutation> representatives; //representatives[id] = canonical representative of coset id
+
+	int expanded; //cosets 0, ... , expanded-1 have had all generators of G applied to them
+
+	bool expand_next(); //applies the generators of G to the next unexpanded coset; returns false once every coset is known
+
+	int find_or_add(const Permutation& rep); //id of the coset with canonical representative rep, adding it if it is new
+
+public:
+
+	CosetTable(const PermGroup& G, const PermGroup& H); //throws InvalidGroupOperation if H is not a subgroup of G
+
+	Permutation canonical_rep(const Permutation& g); //lexicographically smallest element of gH; walks the chain of H once
+	int coset_id(const Permutation& g); //throws InvalidGroupOperation if g is not in G
+	bool same_coset(const Permutation& g, const Permutation& h); //gH == hH
+
+	int discovered() const { return representatives.size(); } //number of cosets found so far
+	Permutation representative(int id); //canonical representative of coset id; enumerates only as many cosets as needed
+	std::vector<Permutation> transversal(); //all canonical representatives, completing the enumeration
+
+	int index(); //|G:H|; completes the enumeration
+};
@@ -0,0 +1,66 @@
+#include "FrozenPermGroup.h"
+
+FrozenPermGroup::FrozenPermGroup(const PermGroup& G) :
+	G(G)
+{
+}
+
+const PermGroup& FrozenPermGroup::built() const
+{
+	std::call_once(chain_built, [this]()
+	{
+		if (!G.has_chain())
+		{
+			G.fast_schreier_sims();
+		}
+	});
+
+	return G;
+}
+
+bool FrozenPermGroup::contains(const Permutation& g) const
+{
+	const PermGroup& H = built();
+
+	if (g.size() != H.n)
+	{
+		return false;
+	}
+
+	return H.filter(g).first == H.n - 1;
+}
+
+unsigned long long int FrozenPermGroup::order() const
+{
+	const PermGroup& H = built();
+
+	unsigned long long int order = 1;
+
+	for (int i = 0; i < H.n - 1; i++)
+	{
+		order *= H.level_size(i);
+	}
+
+	return order;
+}
+
+std::vector<unsigned long long int> FrozenPermGroup::order_factors() const
+{
+	const PermGroup& H = built();
+
+	std::vector<unsigned long long int> out;
+
+	for (int i = 0; i < H.n - 1; i++)
+	{
+		out.push_back(H.level_size(i));
+	}
+
+	return out;
+}
+
+void FrozenPermGroup::print_strong_gens() const
+{
+	built();
+
+	G.print_strong_gens(); //the chain exists, so this only reads it
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+
+#include "Permutation.h"
+#include "PermGroup.h"
+
+class FrozenPermGroup //immutable copy of a PermGroup; its chain is built exactly once, after which every query is const and takes no lock, so any number of threads may share one
+{
+
+private:
+
+	mutable PermGroup G; //only written inside built(), under chain_built
+	mutable std::once_flag chain_built;
+
+	const PermGroup& built() const; //builds the chain on the first call from any thread; later calls return at once
+
+public:
+
+	FrozenPermGroup(const PermGroup& G);
+
+	FrozenPermGroup(const FrozenPermGroup&) = delete; //share by reference instead
+	FrozenPermGroup& operator=(const FrozenPermGroup&) = delete;
+
+	int degree() const { return G.degree(); }
+	const std::vector<Permutation>& get_generators() const { return G.get_generators(); }
+
+	bool contains(const Permutation& g) const;
+	unsigned long long int order() const;
+	std::vector<unsigned long long int> order_factors() const;
+
+	void print_strong_gens() const;
+
+	const PermGroup& group() const { return built(); } //the underlying group, chain included, for further const use
+};
@@ -0,0 +1,884 @@
+#include "LuksIsomorphism.h"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+#include "GraphLibrary/CSRGraph.h"
+#include "GraphLibrary/ColorRefinement.h"
+#include "GraphLibrary/DisjointSets.h"
+#include "GraphLibrary/GraphInvariants.h"
+
+using std::vector;
+using std::set;
+using std::map;
+
+static vector<int> compose(const vector<int>& y, const Permutation& g) //u -> y[g[u]]
+{
+	vector<int> out(y.size());
+
+	for (int u = 0; u < y.size(); u++)
+	{
+		out[u] = y[g[u]];
+	}
+
+	return out;
+}
+
+static const int max_generators = 64;
+
+static PermGroup reduced_group(const vector<Permutation>& gens, int n) //<gens> by few generators; Schreier-Sims runs on just the points they move, often far fewer than n
+{
+	vector<int> support;
+	vector<int> index(n, -1);
+
+	for (int p = 0; p < n; p++)
+	{
+		for (const Permutation& g : gens)
+		{
+			if (g[p] != p)
+			{
+				index[p] = support.size();
+				support.push_back(p);
+				break;
+			}
+		}
+	}
+
+	if (support.empty())
+	{
+		return PermGroup(n);
+	}
+
+	vector<Permutation> restricted;
+
+	for (const Permutation& g : gens)
+	{
+		vector<int> values(support.size());
+
+		for (int i = 0; i < support.size(); i++)
+		{
+			values[i] = index[g[support[i]]];
+		}
+
+		restricted.push_back(Permutation(values));
+	}
+
+	PermGroup S(restricted);
+
+	S.reduce_generators(false); //one Schreier-Sims check per kept generator cost more than all the rest of the search on large 2-groups
+
+	vector<Permutation> out;
+
+	for (const Permutation& h : S.get_generators())
+	{
+		vector<int> values(n);
+
+		for (int p = 0; p < n; p++)
+		{
+			values[p] = p;
+		}
+
+		for (int i = 0; i < support.size(); i++)
+		{
+			values[support[i]] = support[h[i]];
+		}
+
+		out.push_back(Permutation(values));
+	}
+
+	return PermGroup(out);
+}
+
+bool string_isomorphisms(PermGroup& G, const std::vector<int>& W, const std::vector<int>& x, const std::vector<int>& y, Coset& out)
+{
+	vector<int> support; //G-invariant, and G acts faithfully on it
+
+	for (int p = 0; p < G.degree(); p++)
+	{
+		for (const Permutation& g : G.get_generators())
+		{
+			if (g[p] != p)
+			{
+				support.push_back(p);
+				break;
+			}
+		}
+	}
+
+	return string_isomorphisms(G, support, W, x, y, out);
+}
+
+bool string_isomorphisms(PermGroup& G, const std::vector<int>& core, const std::vector<int>& W, const std::vector<int>& x, const std::vector<int>& y, Coset& out)
+{
+	int n = G.degree();
+
+	if (W.empty() || G.is_trivial())
+	{
+		for (int w : W)
+		{
+			if (x[w] != y[w])
+			{
+				return false;
+			}
+		}
+
+		out = { Permutation(n), G };
+		return true;
+	}
+
+	bool preserved = true; //y = x on W and every generator preserves x there, so all of G qualifies; common in the automorphism case
+
+	for (int w : W)
+	{
+		if (x[w] != y[w])
+		{
+			preserved = false;
+			break;
+		}
+	}
+
+	for (int j = 0; preserved && j < G.get_generators().size(); j++)
+	{
+		for (int w : W)
+		{
+			if (x[w] != x[G.get_generators()[j][w]])
+			{
+				preserved = false;
+				break;
+			}
+		}
+	}
+
+	if (preserved)
+	{
+		out = { Permutation(n), G };
+		return true;
+	}
+
+	DisjointSets orbits(n);
+
+	for (const Permutation& g : G.get_generators())
+	{
+		for (int w : W)
+		{
+			orbits.unite(w, g[w]);
+		}
+	}
+
+	vector<int> first_orbit;
+	vector<int> rest;
+
+	for (int w : W)
+	{
+		(orbits.find(w) == orbits.find(W[0]) ? first_orbit : rest).push_back(w);
+	}
+
+	if (!rest.empty()) //intransitive: the isomorphisms on the first orbit form a coset tau K, and those on the rest are tau times the ones of K from x to y tau
+	{
+		Coset first = { Permutation(n), PermGroup(n) };
+
+		if (!string_isomorphisms(G, core, first_orbit, x, y, first))
+		{
+			return false;
+		}
+
+		Coset second = { Permutation(n), PermGroup(n) };
+
+		if (!string_isomorphisms(first.subgroup, core, rest, x, compose(y, first.representative), second))
+		{
+			return false;
+		}
+
+		out = { first.representative * second.representative, second.subgroup };
+		return true;
+	}
+
+	if (W.size() == 1) //G fixes the only point
+	{
+		if (x[W[0]] != y[W[0]])
+		{
+			return false;
+		}
+
+		out = { Permutation(n), G };
+		return true;
+	}
+
+	//Transitive: N, the kernel of the action on maximal blocks (on the points themselves if G is primitive on W), is intransitive on W, and G is a union of
+	//few cosets r N, since G acts primitively on the blocks. Each coset is solved through N; the solutions found all share N's part of the answer.
+	//The blocks, the cosets and Schreier generators of N are found on core and W alone: both are G-invariant and G acts faithfully on core, so nothing is
+	//lost, and they are often far fewer points than the domain. Only the reps and the Schreier generators kept for N are then formed on all n points.
+
+	vector<int> points = core;
+
+	points.insert(points.end(), W.begin(), W.end());
+	std::sort(points.begin(), points.end());
+	points.erase(std::unique(points.begin(), points.end()), points.end());
+
+	vector<int> index(n, -1);
+
+	for (int i = 0; i < points.size(); i++)
+	{
+		index[points[i]] = i;
+	}
+
+	const vector<Permutation>& generators = G.get_generators();
+	vector<Permutation> restricted;
+
+	for (const Permutation& g : generators)
+	{
+		vector<int> values(points.size());
+
+		for (int i = 0; i < points.size(); i++)
+		{
+			values[i] = index[g[points[i]]];
+		}
+
+		restricted.push_back(Permutation(values));
+	}
+
+	set<int> W_points;
+
+	for (int w : W)
+	{
+		W_points.insert(index[w]);
+	}
+
+	PermGroup S(restricted);
+
+	BlockSystem B = S.minimal_block_system(W_points);
+
+	const Permutation identity(points.size());
+
+	vector<Permutation> reps = { identity }; //one element of G per action on the blocks
+	vector<Permutation> rep_inverses = { identity };
+	vector<Permutation> full_reps = { Permutation(n) };
+	vector<Permutation> full_rep_inverses = { Permutation(n) };
+	map<vector<int>, int> actions; //index in reps of each action
+
+	auto action = [&](const Permutation& g)
+	{
+		vector<int> blocks(B.size());
+
+		for (int b = 0; b < B.size(); b++)
+		{
+			blocks[b] = B.block(g[B.first(b)]);
+		}
+
+		return blocks;
+	};
+
+	actions[action(reps[0])] = 0;
+
+	map<Permutation, std::tuple<int, int, int>> schreier_gens; //Schreier generators r_f^-1 s_j r_k of N, r_f being the rep acting on the blocks as s_j r_k does; each with the (f, j, k) that first gave it
+
+	for (int k = 0; k < reps.size(); k++)
+	{
+		for (int j = 0; j < restricted.size(); j++)
+		{
+			Permutation h = restricted[j] * reps[k];
+			vector<int> blocks = action(h);
+
+			auto found = actions.find(blocks);
+
+			if (found == actions.end())
+			{
+				actions[blocks] = reps.size();
+				reps.push_back(h);
+				rep_inverses.push_back(h.inverse());
+				full_reps.push_back(generators[j] * full_reps[k]);
+				full_rep_inverses.push_back(full_reps.back().inverse());
+			}
+
+			else
+			{
+				Permutation schreier = rep_inverses[found->second] * h;
+
+				if (!(schreier == identity))
+				{
+					schreier_gens.emplace(schreier, std::make_tuple(found->second, j, k)); //a repeat keeps its first origin
+				}
+			}
+		}
+	}
+
+	vector<Permutation> kept;
+
+	for (auto& pair : schreier_gens)
+	{
+		kept.push_back(pair.first);
+	}
+
+	if (kept.size() > max_generators) //Schreier-Sims only once the Schreier generators pile up, since it costs far more than carrying a few extra
+	{
+		kept = reduced_group(kept, points.size()).get_generators();
+	}
+
+	vector<Permutation> kernel_gens;
+
+	for (const Permutation& h : kept)
+	{
+		auto found = schreier_gens.find(h);
+
+		if (found == schreier_gens.end()) //the identity, when N is trivial
+		{
+			continue;
+		}
+
+		int f = std::get<0>(found->second);
+		int j = std::get<1>(found->second);
+		int k = std::get<2>(found->second);
+
+		kernel_gens.push_back(full_rep_inverses[f] * generators[j] * full_reps[k]);
+	}
+
+	if (kernel_gens.empty())
+	{
+		kernel_gens.push_back(Permutation(n));
+	}
+
+	PermGroup N(kernel_gens);
+
+	bool found = false;
+	Permutation tau(n);
+	vector<Permutation> gens;
+
+	for (const Permutation& r : full_reps)
+	{
+		Coset part = { Permutation(n), PermGroup(n) };
+
+		if (!string_isomorphisms(N, core, W, x, compose(y, r), part))
+		{
+			continue;
+		}
+
+		Permutation t = r * part.representative;
+
+		if (!found)
+		{
+			found = true;
+			tau = t;
+			gens = part.subgroup.get_generators();
+		}
+
+		else
+		{
+			gens.push_back(tau.inverse() * t); //carries x to itself
+		}
+	}
+
+	if (!found)
+	{
+		return false;
+	}
+
+	out = { tau, PermGroup(gens) };
+	return true;
+}
+
+PermGroup edge_automorphism_group(const Graph& G, const Edge& root_edge)
+{
+	DecomposedGraph D(G, root_edge);
+	CSRGraph csr(G);
+
+	int n = G.size();
+
+	vector<int> swap(n); //Aut_e(X_1) exchanges the ends of the root edge
+
+	for (int v = 0; v < n; v++)
+	{
+		swap[v] = v;
+	}
+
+	std::swap(swap[*root_edge.begin()], swap[*root_edge.rbegin()]);
+
+	vector<Permutation> gens = { Permutation(swap) };
+
+	for (int r = 1; r <= D.layers() && r + 1 < n; r++)
+	{
+		ReductionMap reduction;
+
+		reduction.original_collection = D.construct_colored_sets(r);
+
+		for (auto& pair : reduction.original_collection.colors)
+		{
+			reduction.add(pair.first);
+		}
+
+		for (int k = 0; k < reduction.size(); k++) //closes the colored sets under Aut_e(X_r)
+		{
+			set<int> s = reduction.sets[k];
+
+			for (const Permutation& g : gens)
+			{
+				reduction.add(g[s]);
+			}
+		}
+
+		//Aut_e(X_r) acts on the vertices of X_r followed by the points of the reduction; it fixes every other vertex, which is left out.
+
+		vector<int> old_vertices(reduction.original_collection.base_set.begin(), reduction.original_collection.base_set.end());
+		vector<int> local(n, -1);
+
+		for (int i = 0; i < old_vertices.size(); i++)
+		{
+			local[old_vertices[i]] = i;
+		}
+
+		int offset = old_vertices.size();
+		int size = offset + reduction.size();
+
+		vector<Permutation> combined;
+
+		for (const Permutation& g : gens)
+		{
+			vector<int> values(size);
+
+			for (int i = 0; i < offset; i++)
+			{
+				values[i] = local[g[old_vertices[i]]];
+			}
+
+			for (int k = 0; k < reduction.size(); k++)
+			{
+				values[offset + k] = offset + reduction.points.at(g[reduction.sets[k]]);
+			}
+
+			combined.push_back(Permutation(values));
+		}
+
+		vector<int> x(size, 0);
+		vector<int> W;
+
+		for (int k = 0; k < reduction.size(); k++)
+		{
+			x[offset + k] = reduction.point_colors[k];
+			W.push_back(offset + k);
+		}
+
+		PermGroup A(combined);
+		Coset preserving = { Permutation(size), PermGroup(size) };
+
+		vector<int> core(offset); //A acts faithfully on the vertices of X_r, which decide where the sets go
+
+		for (int i = 0; i < offset; i++)
+		{
+			core[i] = i;
+		}
+
+		string_isomorphisms(A, core, W, x, x, preserving); //never empty: the identity preserves the colors
+
+		map<set<int>, vector<int>> twins; //new vertices by their neighbors in layer r
+
+		for (int v : D.layer(r + 1))
+		{
+			set<int> image;
+
+			for (const int* j = csr.begin(v); j != csr.end(v); j++)
+			{
+				if (D.layer(r).count(*j))
+				{
+					image.insert(*j);
+				}
+			}
+
+			twins[image].push_back(v);
+		}
+
+		vector<Permutation> lifted;
+
+		for (const Permutation& g : preserving.subgroup.get_generators()) //each extends to X_{r+1} by mapping twins to twins
+		{
+			vector<int> values(n);
+
+			for (int v = 0; v < n; v++)
+			{
+				values[v] = v;
+			}
+
+			for (int i = 0; i < offset; i++)
+			{
+				values[old_vertices[i]] = old_vertices[g[i]];
+			}
+
+			for (auto& pair : twins)
+			{
+				set<int> image;
+
+				for (int s : pair.first)
+				{
+					image.insert(values[s]);
+				}
+
+				const vector<int>& targets = twins.at(image);
+
+				for (int j = 0; j < pair.second.size(); j++)
+				{
+					values[pair.second[j]] = targets[j];
+				}
+			}
+
+			Permutation h(values);
+
+			if (!(h == Permutation(n)))
+			{
+				lifted.push_back(h);
+			}
+		}
+
+		for (auto& pair : twins) //Sym of each twin class, by a transposition and a full cycle
+		{
+			const vector<int>& L = pair.second;
+
+			if (L.size() < 2)
+			{
+				continue;
+			}
+
+			vector<int> transposition(n);
+			vector<int> cycle(n);
+
+			for (int v = 0; v < n; v++)
+			{
+				transposition[v] = cycle[v] = v;
+			}
+
+			std::swap(transposition[L[0]], transposition[L[1]]);
+
+			for (int j = 0; j < L.size(); j++)
+			{
+				cycle[L[j]] = L[(j + 1) % L.size()];
+			}
+
+			lifted.push_back(Permutation(transposition));
+
+			if (L.size() > 2)
+			{
+				lifted.push_back(Permutation(cycle));
+			}
+		}
+
+		if (lifted.empty())
+		{
+			lifted.push_back(Permutation(n));
+		}
+
+		gens = lifted.size() > max_generators ? reduced_group(lifted, n).get_generators() : lifted;
+	}
+
+	return PermGroup(gens);
+}
+
+static Graph induced_subgraph(const Graph& G, const vector<int>& vertices) //vertices[i] becomes i
+{
+	vector<int> local(G.size(), -1);
+
+	for (int i = 0; i < vertices.size(); i++)
+	{
+		local[vertices[i]] = i;
+	}
+
+	Graph out(vertices.size());
+
+	for (int i = 0; i < vertices.size(); i++)
+	{
+		for (int j : G.adj_list()[vertices[i]])
+		{
+			if (local[j] > i)
+			{
+				out.insert_edge(i, local[j]);
+			}
+		}
+	}
+
+	return out;
+}
+
+static bool connected_isomorphism(const Graph& G, const Graph& H, vector<int>& out) //G and H connected, of equal size; out[v] = image of v
+{
+	int k = G.size();
+
+	if (k == 1)
+	{
+		out = { 0 };
+		return true;
+	}
+
+	vector<std::pair<int, int>> union_edges; //G on 0, ... , k-1 and H on k, ... , 2k-1, refined together so that their colors compare
+
+	for (int v = 0; v < k; v++)
+	{
+		for (int j : G.adj_list()[v])
+		{
+			union_edges.push_back({ v, j });
+		}
+
+		for (int j : H.adj_list()[v])
+		{
+			union_edges.push_back({ k + v, k + j });
+		}
+	}
+
+	CSRGraph both(2 * k, union_edges);
+	ColorRefinement refiner(both);
+
+	auto balanced = [&](const vector<int>& colors) //an isomorphism preserves stable colors, so each color is as common in G as in H
+	{
+		map<int, int> balance;
+
+		for (int v = 0; v < k; v++)
+		{
+			balance[colors[v]]++;
+			balance[colors[k + v]]--;
+		}
+
+		for (auto& pair : balance)
+		{
+			if (pair.second != 0)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	};
+
+	vector<int> colors = ColorRefinement::stable_colors(both, vector<int>(2 * k, 0));
+
+	if (!balanced(colors))
+	{
+		return false;
+	}
+
+	map<std::pair<int, int>, vector<std::pair<int, int>>> H_edges; //by the colors of their ends, the lesser first
+
+	for (int c = 0; c < k; c++)
+	{
+		for (int d : H.adj_list()[c])
+		{
+			if (colors[k + c] < colors[k + d] || (colors[k + c] == colors[k + d] && c < d))
+			{
+				H_edges[{ colors[k + c], colors[k + d] }].push_back({ c, d });
+			}
+		}
+	}
+
+	int a = -1; //root edge ab of G whose colors are rarest in H; the root edge must go to an edge of H with the same colors
+	int b = -1;
+	int candidates = 0;
+
+	for (int v = 0; v < k; v++)
+	{
+		for (int j : G.adj_list()[v])
+		{
+			std::pair<int, int> key = { std::min(colors[v], colors[j]), std::max(colors[v], colors[j]) };
+			auto found = H_edges.find(key);
+			int count = found == H_edges.end() ? 0 : found->second.size();
+
+			if (a == -1 || count < candidates)
+			{
+				a = colors[v] <= colors[j] ? v : j;
+				b = a == v ? j : v;
+				candidates = count;
+			}
+		}
+	}
+
+	std::pair<int, int> key = { colors[a], colors[b] };
+
+	if (candidates == 0)
+	{
+		return false;
+	}
+
+	int p = 2 * k; //subdivides ab
+	int q = 2 * k + 1; //subdivides cd
+
+	for (auto f : H_edges[key])
+	{
+		vector<int> marked = colors; //the root edge and f singled out; if refining then tells G and H apart, no isomorphism takes one to the other
+
+		for (int v : { a, b, k + f.first, k + f.second })
+		{
+			marked[v] += 2 * k;
+		}
+
+		OrderedPartition P(marked);
+
+		refiner.refine(P);
+
+		if (!balanced(P.colors()))
+		{
+			continue;
+		}
+
+		if (P.cells() == k) //balanced, so each cell holds one vertex of G and one of H; that settles the only candidate, which is checked directly
+		{
+			vector<int> H_vertex(2 * k);
+
+			for (int v = 0; v < k; v++)
+			{
+				H_vertex[P.cell(k + v)] = v;
+			}
+
+			vector<int> candidate(k);
+			bool preserves = true;
+
+			for (int v = 0; v < k; v++)
+			{
+				candidate[v] = H_vertex[P.cell(v)];
+			}
+
+			for (int v = 0; v < k && preserves; v++)
+			{
+				for (int j : G.adj_list()[v])
+				{
+					if (!H.has_edge(candidate[v], candidate[j]))
+					{
+						preserves = false;
+						break;
+					}
+				}
+			}
+
+			if (preserves)
+			{
+				out = candidate;
+				return true;
+			}
+
+			continue;
+		}
+
+		Graph X(2 * k + 2);
+
+		for (auto& e : union_edges)
+		{
+			if (e.first < e.second)
+			{
+				X.insert_edge(e.first, e.second);
+			}
+		}
+
+		X.delete_edge(a, b);
+		X.delete_edge(k + f.first, k + f.second);
+
+		X.insert_edge(a, p);
+		X.insert_edge(p, b);
+		X.insert_edge(k + f.first, q);
+		X.insert_edge(q, k + f.second);
+		X.insert_edge(p, q);
+
+		PermGroup A = edge_automorphism_group(X, { p, q });
+
+		for (const Permutation& g : A.get_generators())
+		{
+			if (g[p] == q) //swaps the sides, so carries G onto H
+			{
+				out.assign(k, 0);
+
+				for (int v = 0; v < k; v++)
+				{
+					out[v] = g[v] - k;
+				}
+
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+IsomorphismResult bounded_degree_isomorphism(const Graph& G, const Graph& H)
+{
+	int n = G.size();
+
+	IsomorphismResult result = { false, Permutation(n), NonIsomorphismWitness::none, -1 };
+
+	if (n != H.size() || G.edges() != H.edges())
+	{
+		result.witness = NonIsomorphismWitness::sizes;
+		return result;
+	}
+
+	if (graph_invariants(G) != graph_invariants(H))
+	{
+		result.witness = NonIsomorphismWitness::invariants;
+		return result;
+	}
+
+	ComponentLabels G_labels = G.component_labels();
+	ComponentLabels H_labels = H.component_labels();
+
+	vector<vector<int>> G_components(G_labels.count());
+	vector<vector<int>> H_components(H_labels.count());
+
+	for (int v = 0; v < n; v++)
+	{
+		G_components[G_labels.component[v]].push_back(v);
+		H_components[H_labels.component[v]].push_back(v);
+	}
+
+	vector<Graph> G_subgraphs;
+	vector<Graph> H_subgraphs;
+
+	for (const vector<int>& C : G_components)
+	{
+		G_subgraphs.push_back(induced_subgraph(G, C));
+	}
+
+	for (const vector<int>& D : H_components)
+	{
+		H_subgraphs.push_back(induced_subgraph(H, D));
+	}
+
+	vector<GraphInvariants> G_invariants = graph_invariants(G_subgraphs);
+	vector<GraphInvariants> H_invariants = graph_invariants(H_subgraphs);
+
+	map<uint64_t, vector<int>> free_components; //free components of H by their invariants, so that only components with equal invariants are tried
+
+	for (int d = 0; d < H_components.size(); d++)
+	{
+		free_components[H_invariants[d].combined()].push_back(d);
+	}
+
+	vector<int> image(n);
+
+	for (int c = 0; c < G_components.size(); c++) //isomorphism is an equivalence, so matching each component with the first free isomorphic one never goes wrong
+	{
+		const vector<int>& C = G_components[c];
+		vector<int>& bucket = free_components[G_invariants[c].combined()];
+		bool found = false;
+
+		for (int i = 0; i < bucket.size() && !found; i++)
+		{
+			int d = bucket[i];
+			vector<int> local;
+
+			if (G_invariants[c] == H_invariants[d] && connected_isomorphism(G_subgraphs[c], H_subgraphs[d], local)) //equal invariants imply equal sizes
+			{
+				for (int v = 0; v < C.size(); v++)
+				{
+					image[C[v]] = H_components[d][local[v]];
+				}
+
+				bucket.erase(bucket.begin() + i);
+				found = true;
+			}
+		}
+
+		if (!found)
+		{
+			result.witness = NonIsomorphismWitness::component;
+			result.component_vertex = C[0];
+			return result;
+		}
+	}
+
+	result.isomorphic = true;
+	result.isomorphism = Permutation(image);
+
+	return result;
+}
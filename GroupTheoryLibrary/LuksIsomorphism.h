@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "Permutation.h"
+#include "PermGroup.h"
+
+#include "GraphLibrary/Graph.h"
+#include "GraphLibrary/DecomposedGraph.h"
+
+//Luks' isomorphism test for graphs of bounded degree. Aut_e(X), the automorphisms fixing the root edge e setwise, is computed for X_1, X_2, ... of the
+//DecomposedGraph in turn: Aut_e(X_{r+1}) restricted to X_r is the subgroup of Aut_e(X_r) preserving the colored sets of layer r, and the rest of it permutes
+//new vertices with the same neighbors in layer r. That subgroup is found by Luks' divide and conquer over orbits and block systems, which takes polynomial time
+//for the groups arising from graphs of bounded degree.
+
+enum class NonIsomorphismWitness
+{
+	none, //the graphs are isomorphic
+	sizes, //different numbers of vertices or edges
+	invariants, //different GraphInvariants, or different stable colors once both graphs are refined together
+	component //the component of component_vertex matches no free component of H: none has its GraphInvariants, or each that does fails the balance of stable colors, or, for every candidate image f of the root edge, the balance test with both edges singled out, the direct check of a fully refined map, or Aut_pq moving p once the subdivided root edge and f are joined by pq
+};
+
+struct IsomorphismResult
+{
+	bool isomorphic;
+	Permutation isomorphism; //isomorphism[v] = image in H of v in G; the identity unless isomorphic
+
+	NonIsomorphismWitness witness;
+	int component_vertex; //vertex of G for witness component, -1 otherwise
+};
+
+PermGroup edge_automorphism_group(const Graph& G, const Edge& root_edge); //Aut_e(G) restricted to the component of root_edge; every other vertex is fixed; throws InvalidDecomposition unless root_edge is an edge of G
+
+IsomorphismResult bounded_degree_isomorphism(const Graph& G, const Graph& H); //components are bucketed by GraphInvariants and matched one by one within their bucket, each by at most one Aut_e computation per candidate edge of H
+
+bool string_isomorphisms(PermGroup& G, const std::vector<int>& W, const std::vector<int>& x, const std::vector<int>& y, Coset& out); //W is G-invariant; if some g in G has x[w] = y[g[w]] for every w in W, sets out to the coset of all of them, as out.representative * out.subgroup, and returns true
+bool string_isomorphisms(PermGroup& G, const std::vector<int>& core, const std::vector<int>& W, const std::vector<int>& x, const std::vector<int>& y, Coset& out); //the same, given a G-invariant core on which G acts faithfully; each transitive step then works on core and one orbit of W rather than on every point G moves
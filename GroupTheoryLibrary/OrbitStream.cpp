@@ -0,0 +1,114 @@
+#include "OrbitStream.h"
+
+using std::vector;
+
+OrbitStream::OrbitStream(const PermGroup& G, int start) :
+	G(G),
+	start(start),
+	expanded(0),
+	indexed(0)
+{
+	if (start < 0 || start >= G.degree())
+	{
+		throw InvalidGroupOperation();
+	}
+
+	seen.assign(G.degree(), false);
+	seen[start] = true;
+
+	discovered.push_back(start);
+	edge_labels.push_back(-1);
+	parents.push_back(-1);
+}
+
+bool OrbitStream::advance()
+{
+	while (expanded < discovered.size())
+	{
+		const std::vector<Permutation>& generators = G.get_generators();
+
+		int p = discovered[expanded];
+		int found_before = discovered.size();
+
+		expanded++;
+
+		for (int j = 0; j < generators.size(); j++)
+		{
+			int q = generators[j][p];
+
+			if (!seen[q])
+			{
+				seen[q] = true;
+				discovered.push_back(q);
+				edge_labels.push_back(j);
+				parents.push_back(expanded - 1);
+			}
+		}
+
+		if (discovered.size() > found_before)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+OrbitStream::iterator& OrbitStream::iterator::operator++()
+{
+	index++;
+
+	if (index == stream->discovered.size() && !stream->advance())
+	{
+		index = -1;
+	}
+
+	return *this;
+}
+
+bool OrbitStream::contains(int p)
+{
+	if (p < 0 || p >= G.degree())
+	{
+		return false;
+	}
+
+	while (!seen[p])
+	{
+		if (!advance())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+Permutation OrbitStream::transversal(int p) const
+{
+	if (p < 0 || p >= G.degree() || !seen[p])
+	{
+		throw InvalidGroupOperation();
+	}
+
+	const std::vector<Permutation>& generators = G.get_generators();
+
+	if (position.empty())
+	{
+		position.assign(G.degree(), -1);
+	}
+
+	for (; indexed < discovered.size(); indexed++) //only points found since the last call
+	{
+		position[discovered[indexed]] = indexed;
+	}
+
+	Permutation u(G.degree());
+
+	for (int i = position[p]; i != 0; i = parents[i]) //the edge into p is applied last
+	{
+		u = u * generators[edge_labels[i]];
+	}
+
+	return u;
+}
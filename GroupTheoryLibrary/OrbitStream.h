@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <iterator>
+
+#include "Permutation.h"
+#include "PermGroup.h"
+
+class OrbitStream //orbit of a point under the generators of a group, discovered breadth first and only as far as the consumer reads
+{
+
+private:
+
+	const PermGroup& G;
+	int start;
+
+	std::vector<bool> seen; //one bit per point; the BFS tree below grows with the orbit, not with the degree
+
+	std::vector<int> discovered; //orbit points in the order they were found
+	std::vector<int> edge_labels; //edge_labels[i] = generator carrying discovered[parents[i]] to discovered[i], -1 at start
+	std::vector<int> parents; //positions in discovered
+
+	mutable std::vector<int> position; //position[p] = index of p in discovered; allocated by the first transversal call
+	mutable int indexed; //discovered[0], ... , discovered[indexed-1] have their position filled in
+	int expanded; //discovered[0], ... , discovered[expanded-1] have had every generator applied
+
+	bool advance(); //applies the generators to the next unexpanded point; returns false once the orbit is complete
+
+public:
+
+	class iterator
+	{
+
+	private:
+
+		OrbitStream* stream;
+		int index; //position in stream->discovered, or -1 past the end
+
+	public:
+
+		using iterator_category = std::input_iterator_tag;
+		using value_type = int;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const int*;
+		using reference = const int&;
+
+		iterator(OrbitStream* stream, int index) : stream(stream), index(index) {}
+
+		const int& operator*() const { return stream->discovered[index]; }
+		iterator& operator++(); //explores just far enough to find the next point
+
+		bool operator==(const iterator& other) const { return index == other.index; }
+		bool operator!=(const iterator& other) const { return index != other.index; }
+	};
+
+	OrbitStream(const PermGroup& G, int start); //G is referenced, not copied, and must outlive the stream; nothing is explored yet
+
+	iterator begin() { return iterator(this, 0); }
+	iterator end() { return iterator(this, -1); }
+
+	bool contains(int p); //explores only until p turns up, or the orbit is exhausted
+	Permutation transversal(int p) const; //element of G mapping start to p, rebuilt from the BFS tree; p must already have been discovered
+
+	int discovered_count() const { return discovered.size(); }
+	bool complete() const { return expanded == discovered.size(); }
+};
@@ -0,0 +1,525 @@
+#include "PcGroup.h"
+
+#include <iostream>
+#include <algorithm>
+
+using std::vector;
+
+static Permutation perm_power(const Permutation& g, int k)
+{
+	Permutation out(g.size());
+
+	for (int i = 0; i < k; i++)
+	{
+		out = out * g;
+	}
+
+	return out;
+}
+
+PcGroup::PcGroup(PermGroup& G) :
+	n(G.degree()),
+	m(0)
+{
+	vector<PermGroup> series = G.derived_series();
+
+	if (!series.back().is_trivial())
+	{
+		throw NonSolvableGroup();
+	}
+
+	PermGroup N(n); //grows from the bottom of the derived series up to G
+
+	vector<Permutation> bottom_up_pcgs;
+	vector<int> bottom_up_orders;
+
+	for (int k = series.size() - 2; k >= 0; k--) //N = G^(k+1) here, and G^(k)/G^(k+1) is abelian, so every group between them is normal in G^(k)
+	{
+		const vector<Permutation>& gens = series[k].get_generators();
+
+		for (int i = 0; i < gens.size(); i++)
+		{
+			if (N.contains(gens[i]))
+			{
+				continue;
+			}
+
+			int r = 1; //order of gens[i] modulo N
+			Permutation a = gens[i];
+
+			while (!N.contains(a))
+			{
+				a = a * gens[i];
+				r++;
+			}
+
+			vector<int> primes;
+			int rest = r;
+
+			for (int p = 2; p * p <= rest; p++)
+			{
+				while (rest % p == 0)
+				{
+					primes.push_back(p);
+					rest /= p;
+				}
+			}
+
+			if (rest > 1)
+			{
+				primes.push_back(rest);
+			}
+
+			int exponent = r;
+
+			for (int j = 0; j < primes.size(); j++) //adds gens[i]^(r/p_0), gens[i]^(r/p_0 p_1), ... , gens[i], each of prime order modulo the last
+			{
+				exponent /= primes[j];
+
+				Permutation b = perm_power(gens[i], exponent);
+
+				bottom_up_pcgs.push_back(b);
+				bottom_up_orders.push_back(primes[j]);
+
+				N.add_generator(b);
+			}
+		}
+	}
+
+	pcgs.assign(bottom_up_pcgs.rbegin(), bottom_up_pcgs.rend());
+	relative_orders.assign(bottom_up_orders.rbegin(), bottom_up_orders.rend());
+	m = pcgs.size();
+
+	build_presentation();
+}
+
+PcGroup::PcGroup(int degree, const vector<Permutation>& sequence, const vector<int>& orders) :
+	n(degree),
+	m(sequence.size()),
+	pcgs(sequence),
+	relative_orders(orders)
+{
+	build_presentation();
+}
+
+void PcGroup::build_presentation()
+{
+	powers.assign(m, {});
+	conjugates.assign(m, vector<vector<int>>(m));
+
+	for (int i = m - 1; i >= 0; i--) //relations of g_i only involve G_{i+1}, whose presentation and chain are complete by now
+	{
+		build_levels(i + 1);
+
+		std::pair<bool, vector<int>> sifted = sift(perm_power(pcgs[i], relative_orders[i]));
+
+		if (!sifted.first)
+		{
+			throw NonSolvableGroup();
+		}
+
+		powers[i] = sifted.second;
+
+		Permutation g_inverse = pcgs[i].inverse();
+
+		for (int j = i + 1; j < m; j++)
+		{
+			sifted = sift(g_inverse * pcgs[j] * pcgs[i]);
+
+			if (!sifted.first)
+			{
+				throw NonSolvableGroup();
+			}
+
+			conjugates[i][j] = sifted.second;
+		}
+	}
+
+	build_levels(0);
+}
+
+void PcGroup::build_levels(int top)
+{
+	levels.clear();
+
+	vector<vector<int>> seq;
+	vector<Permutation> seq_perms;
+	vector<int> seq_orders;
+
+	for (int i = top; i < m; i++)
+	{
+		vector<int> unit = identity();
+		unit[i] = 1;
+
+		seq.push_back(unit);
+		seq_perms.push_back(pcgs[i]);
+		seq_orders.push_back(relative_orders[i]);
+	}
+
+	while (!seq.empty())
+	{
+		int point = -1; //first point moved by the current subgroup
+
+		for (int x = 0; x < n && point == -1; x++)
+		{
+			for (int k = 0; k < seq_perms.size(); k++)
+			{
+				if (seq_perms[k][x] != x)
+				{
+					point = x;
+					break;
+				}
+			}
+		}
+
+		if (point == -1)
+		{
+			break;
+		}
+
+		vector<vector<int>> stab;
+		vector<Permutation> stab_perms;
+		vector<int> stab_orders;
+
+		levels.push_back(orbit_stabilizer(point, seq, seq_perms, seq_orders, stab, stab_perms, stab_orders));
+
+		seq = stab;
+		seq_perms = stab_perms;
+		seq_orders = stab_orders;
+	}
+}
+
+PcLevel PcGroup::orbit_stabilizer(int point, const vector<vector<int>>& seq, const vector<Permutation>& seq_perms, const vector<int>& seq_orders,
+	vector<vector<int>>& stab, vector<Permutation>& stab_perms, vector<int>& stab_orders) const
+{
+	PcLevel level;
+
+	level.point = point;
+	level.orbit = { point };
+	level.orbit_index.assign(n, -1);
+	level.orbit_index[point] = 0;
+	level.transversal = { identity() };
+	level.transversal_inverses = { Permutation(n) };
+
+	stab.clear();
+	stab_perms.clear();
+	stab_orders.clear();
+
+	for (int k = seq.size() - 1; k >= 0; k--) //level.orbit is the orbit of point under <seq[k+1], ... >
+	{
+		const Permutation& s = seq_perms[k];
+
+		int image = s[point];
+
+		if (level.orbit_index[image] != -1) //s fixes the orbit, so the stabilizer grows by a factor of seq_orders[k]
+		{
+			int t = level.orbit_index[image];
+
+			stab.push_back(multiply(inverse(level.transversal[t]), seq[k]));
+			stab_perms.push_back(level.transversal_inverses[t] * s);
+			stab_orders.push_back(seq_orders[k]);
+		}
+
+		else //the images of the orbit under s, ... , s^(p-1) are disjoint from it and from each other
+		{
+			int old_size = level.orbit.size();
+
+			Permutation s_inverse = s.inverse();
+
+			vector<int> s_power = seq[k];
+			Permutation s_power_perm = s;
+			Permutation s_power_inverse = s_inverse;
+
+			for (int e = 1; e < seq_orders[k]; e++)
+			{
+				for (int t = 0; t < old_size; t++)
+				{
+					int new_point = s_power_perm[level.orbit[t]];
+
+					level.orbit_index[new_point] = level.orbit.size();
+					level.orbit.push_back(new_point);
+					level.transversal.push_back(multiply(s_power, level.transversal[t]));
+					level.transversal_inverses.push_back(level.transversal_inverses[t] * s_power_inverse);
+				}
+
+				s_power = multiply(s_power, seq[k]);
+				s_power_perm = s_power_perm * s;
+				s_power_inverse = s_power_inverse * s_inverse;
+			}
+		}
+	}
+
+	std::reverse(stab.begin(), stab.end());
+	std::reverse(stab_perms.begin(), stab_perms.end());
+	std::reverse(stab_orders.begin(), stab_orders.end());
+
+	return level;
+}
+
+void PcGroup::collect_generator(vector<int>& w, int i) const
+{
+	vector<int> tail;
+
+	for (int j = i + 1; j < m; j++)
+	{
+		if (w[j] != 0)
+		{
+			tail.assign(w.begin() + i + 1, w.end());
+			std::fill(w.begin() + i + 1, w.end(), 0);
+			break;
+		}
+	}
+
+	w[i]++;
+
+	if (w[i] == relative_orders[i])
+	{
+		w[i] = 0;
+		collect_word(w, powers[i]);
+	}
+
+	for (int j = 0; j < tail.size(); j++) //moving g_i to the left of the tail conjugates the tail by g_i
+	{
+		for (int k = 0; k < tail[j]; k++)
+		{
+			collect_word(w, conjugates[i][i + 1 + j]);
+		}
+	}
+}
+
+void PcGroup::collect_word(vector<int>& w, const vector<int>& v) const
+{
+	for (int j = 0; j < m; j++)
+	{
+		for (int k = 0; k < v[j]; k++)
+		{
+			collect_generator(w, j);
+		}
+	}
+}
+
+vector<int> PcGroup::multiply(const vector<int>& u, const vector<int>& v) const
+{
+	vector<int> out = u;
+
+	collect_word(out, v);
+
+	return out;
+}
+
+vector<int> PcGroup::inverse(const vector<int>& u) const
+{
+	vector<int> out = identity();
+	vector<int> product = u; //u * out, which is reduced to the identity one position at a time
+
+	for (int i = 0; i < m; i++)
+	{
+		if (product[i] != 0)
+		{
+			out[i] = relative_orders[i] - product[i];
+
+			for (int k = 0; k < out[i]; k++)
+			{
+				collect_generator(product, i);
+			}
+		}
+	}
+
+	return out;
+}
+
+vector<int> PcGroup::power(const vector<int>& u, int k) const
+{
+	vector<int> out = identity();
+
+	for (int i = 0; i < k; i++)
+	{
+		collect_word(out, u);
+	}
+
+	return out;
+}
+
+Permutation PcGroup::element(const vector<int>& exponents) const
+{
+	Permutation out(n);
+
+	for (int i = 0; i < m; i++)
+	{
+		for (int k = 0; k < exponents[i]; k++)
+		{
+			out = out * pcgs[i];
+		}
+	}
+
+	return out;
+}
+
+bool PcGroup::transversal_indices(const Permutation& g, vector<int>& indices) const
+{
+	if (g.size() != n)
+	{
+		return false;
+	}
+
+	indices.resize(levels.size());
+
+	for (int l = 0; l < levels.size(); l++) //the image of the base point under the sifted element, without composing it
+	{
+		int image = g[levels[l].point];
+
+		for (int j = 0; j < l; j++)
+		{
+			image = levels[j].transversal_inverses[indices[j]][image];
+		}
+
+		indices[l] = levels[l].orbit_index[image];
+
+		if (indices[l] == -1)
+		{
+			return false;
+		}
+	}
+
+	for (int x = 0; x < n; x++) //every base point is fixed now, but g may still be outside the group
+	{
+		int image = g[x];
+
+		for (int l = 0; l < levels.size(); l++)
+		{
+			image = levels[l].transversal_inverses[indices[l]][image];
+		}
+
+		if (image != x)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::pair<bool, vector<int>> PcGroup::sift(const Permutation& g) const
+{
+	vector<int> indices;
+
+	if (!transversal_indices(g, indices))
+	{
+		return { false, {} };
+	}
+
+	vector<int> exps = identity(); //collected only once g is known to be in the group
+
+	for (int l = 0; l < levels.size(); l++)
+	{
+		collect_word(exps, levels[l].transversal[indices[l]]);
+	}
+
+	return { true, exps };
+}
+
+vector<int> PcGroup::exponents(const Permutation& g) const
+{
+	std::pair<bool, vector<int>> sifted = sift(g);
+
+	if (!sifted.first)
+	{
+		throw InvalidGroupOperation();
+	}
+
+	return sifted.second;
+}
+
+bool PcGroup::contains(const Permutation& g) const
+{
+	vector<int> indices;
+
+	return transversal_indices(g, indices);
+}
+
+unsigned long long int PcGroup::order() const
+{
+	unsigned long long int order = 1;
+
+	for (int i = 0; i < m; i++)
+	{
+		order *= relative_orders[i];
+	}
+
+	return order;
+}
+
+vector<int> PcGroup::orbit(int point) const
+{
+	vector<vector<int>> seq;
+	vector<Permutation> seq_perms = pcgs;
+
+	for (int i = 0; i < m; i++)
+	{
+		vector<int> unit = identity();
+		unit[i] = 1;
+
+		seq.push_back(unit);
+	}
+
+	vector<vector<int>> stab;
+	vector<Permutation> stab_perms;
+	vector<int> stab_orders;
+
+	return orbit_stabilizer(point, seq, seq_perms, relative_orders, stab, stab_perms, stab_orders).orbit;
+}
+
+PcGroup PcGroup::stabilizer(int point) const
+{
+	vector<vector<int>> seq;
+	vector<Permutation> seq_perms = pcgs;
+
+	for (int i = 0; i < m; i++)
+	{
+		vector<int> unit = identity();
+		unit[i] = 1;
+
+		seq.push_back(unit);
+	}
+
+	vector<vector<int>> stab;
+	vector<Permutation> stab_perms;
+	vector<int> stab_orders;
+
+	orbit_stabilizer(point, seq, seq_perms, relative_orders, stab, stab_perms, stab_orders);
+
+	return PcGroup(n, stab_perms, stab_orders);
+}
+
+void PcGroup::print_presentation() const
+{
+	for (int i = 0; i < m; i++)
+	{
+		std::cout << "g_" << i << "^" << relative_orders[i] << " = ";
+
+		for (int j = 0; j < m; j++)
+		{
+			if (powers[i][j] != 0)
+			{
+				std::cout << "g_" << j << "^" << powers[i][j] << " ";
+			}
+		}
+
+		std::cout << '\n';
+
+		for (int j = i + 1; j < m; j++)
+		{
+			std::cout << "g_" << j << "^g_" << i << " = ";
+
+			for (int k = 0; k < m; k++)
+			{
+				if (conjugates[i][j][k] != 0)
+				{
+					std::cout << "g_" << k << "^" << conjugates[i][j][k] << " ";
+				}
+			}
+
+			std::cout << '\n';
+		}
+	}
+}
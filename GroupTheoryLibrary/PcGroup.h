@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include <exception>
+
+#include "Permutation.h"
+#include "PermGroup.h"
+
+struct PcLevel //one level of the stabilizer chain of a PcGroup
+{
+	int point; //base point of this level
+	std::vector<int> orbit; //orbit of point under the level's subgroup
+	std::vector<int> orbit_index; //orbit_index[i] = position of i in orbit, or -1
+	std::vector<std::vector<int>> transversal; //transversal[k] = exponents of an element mapping point to orbit[k]
+	std::vector<Permutation> transversal_inverses; //inverses of the transversal elements, as permutations
+};
+
+class PcGroup //solvable permutation group given by a polycyclic generating sequence g_0, ... , g_{m-1}
+{
+
+private:
+
+	int n; //degree of the permutations
+	int m; //length of the polycyclic sequence
+
+	std::vector<Permutation> pcgs; //G_i = <g_i, ... , g_{m-1}>; G_{i+1} is normal in G_i of prime index
+	std::vector<int> relative_orders; //relative_orders[i] = |G_i : G_{i+1}|
+
+	std::vector<std::vector<int>> powers; //powers[i] = exponents of g_i^relative_orders[i], an element of G_{i+1}
+	std::vector<std::vector<std::vector<int>>> conjugates; //conjugates[i][j] = exponents of g_i^-1 g_j g_i for j > i, an element of G_{i+1}
+
+	std::vector<PcLevel> levels; //stabilizer chain of the group, built by pc orbit-stabilizer
+
+	PcGroup(int degree, const std::vector<Permutation>& sequence, const std::vector<int>& orders); //sequence must already be a pc sequence with the given prime relative orders
+
+	void build_presentation(); //computes powers, conjugates and levels from pcgs and relative_orders
+	void build_levels(int top); //builds the stabilizer chain of G_top
+
+	PcLevel orbit_stabilizer(int point, const std::vector<std::vector<int>>& seq, const std::vector<Permutation>& seq_perms, const std::vector<int>& seq_orders, 
+		std::vector<std::vector<int>>& stab, std::vector<Permutation>& stab_perms, std::vector<int>& stab_orders) const; //pc orbit algorithm on point for the sequence seq; fills in an induced sequence for the stabilizer
+
+	void collect_generator(std::vector<int>& w, int i) const; //w <- w * g_i, by collection
+	void collect_word(std::vector<int>& w, const std::vector<int>& v) const; //w <- w * v
+
+	bool transversal_indices(const Permutation& g, std::vector<int>& indices) const; //indices[l] = transversal entry of g at level l, if g is in the group; follows only the base point images, O(levels^2), then checks all of g once, O(n levels)
+	std::pair<bool, std::vector<int>> sift(const Permutation& g) const; //(true, exponents of g) if g is in the group, (false, {}) otherwise; collects only after the membership test
+
+public:
+
+	PcGroup(PermGroup& G); //refines the derived series of G to a composition series; throws NonSolvableGroup if G is not solvable
+
+	int degree() const { return n; }
+	int length() const { return m; }
+
+	const std::vector<Permutation>& get_pcgs() const { return pcgs; }
+	const std::vector<int>& get_relative_orders() const { return relative_orders; }
+
+	unsigned long long int order() const;
+
+	std::vector<int> identity() const { return std::vector<int>(m, 0); }
+	std::vector<int> multiply(const std::vector<int>& u, const std::vector<int>& v) const; //exponents of uv
+	std::vector<int> inverse(const std::vector<int>& u) const; //exponents of u^-1
+	std::vector<int> power(const std::vector<int>& u, int k) const; //exponents of u^k, k >= 0
+
+	Permutation element(const std::vector<int>& exponents) const; //returns g_0^e_0 ... g_{m-1}^e_{m-1}
+	std::vector<int> exponents(const Permutation& g) const; //throws InvalidGroupOperation if g is not in the group
+
+	bool contains(const Permutation& g) const; //no collection; an element outside the group is usually rejected at a base point, but accepting one still reads all n points at every level, as PermGroup::contains does
+
+	std::vector<int> orbit(int point) const; //orbit of point, computed from the pc sequence without Schreier generators
+	PcGroup stabilizer(int point) const; //stabilizer of point, with an induced pc sequence
+
+	void print_presentation() const;
+};
+
+class NonSolvableGroup : public std::exception
+{
+public:
+
+	virtual char const* what() const throw()
+	{
+		return "Group is not solvable";
+	}
+};
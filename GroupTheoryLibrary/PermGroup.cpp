@@ -1,14 +1,22 @@
 #include "PermGroup.h"
+#include "OrbitStream.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <map>
+#include <queue>
 
 using std::set;
 using std::vector;
 using std::map;
 
-PermGroup::PermGroup(const std::vector<Permutation>& gens) :
+PermGroup::PermGroup(const std::vector<Permutation>& gens, TransversalStorage storage) :
 	generators(gens),
+	storage(storage),
 	strong_gens({}),
 	num_strong_gens(0)
 {
@@ -30,6 +38,7 @@ PermGroup::PermGroup(const std::vector<Permutation>& gens) :
 }
 
 PermGroup::PermGroup(const std::vector<std::vector<Permutation>>& strong_generators):
+	storage(TransversalStorage::explicit_transversals),
 	strong_gens(strong_generators),
 	n(strong_generators[0][0].size())
 {
@@ -42,547 +51,2630 @@ PermGroup::PermGroup(const std::vector<std::vector<Permutation>>& strong_generat
 	}
 
 	num_strong_gens = generators.size();
+
+	index_transversals();
 }
 
 PermGroup::PermGroup(int size):
 	n(size),
 	generators({Permutation(size)}),
+	storage(TransversalStorage::explicit_transversals),
 	strong_gens({}),
 	num_strong_gens(0)
 {
 	//schreier_sims();
 }
 
-std::pair<int, Permutation> PermGroup::filter(const Permutation& g)
+void PermGroup::set_storage(TransversalStorage new_storage)
 {
-	Permutation gamma = g;
-
-	for (int i = 0; i < n-1; i++)
+	if (new_storage == storage)
 	{
-		bool found_rep = false; 
+		return;
+	}
 
-		for (int j = 0; j < strong_gens[i].size(); j++)
-		{
-			Permutation h = strong_gens[i][j];
+	storage = new_storage;
 
-			if (h[i] == gamma[i])
-			{
-				found_rep = true;
-				gamma = h.inverse() * gamma;
+	strong_gens.clear();
+	transversal_index.clear();
 
-				break;
-			}
-		}
+	schreier_gens.clear();
+	schreier_gen_inverses.clear();
+	shortcut.clear();
+	level_gens.clear();
+	schreier_vectors.clear();
+	level_orbits.clear();
 
-		if (!found_rep)
-		{
-			return std::pair<int, Permutation>(i, gamma);
-		}
+	num_strong_gens = 0;
+}
+
+bool PermGroup::has_chain() const
+{
+	if (storage == TransversalStorage::schreier_vectors)
+	{
+		return level_orbits.size() != 0;
 	}
-	return std::pair<int, Permutation>(n - 1, Permutation(n));
+
+	return strong_gens.size() != 0;
 }
 
-void PermGroup::schreier_sims()
+int PermGroup::level_size(int i) const
 {
-	strong_gens.resize(n - 1);
+	if (storage == TransversalStorage::schreier_vectors)
+	{
+		return level_orbits[i].size();
+	}
 
-	for (int i = 0; i < strong_gens.size(); i++)
+	return strong_gens[i].size();
+}
+
+std::vector<int> PermGroup::level_orbit(int i) const
+{
+	if (storage == TransversalStorage::schreier_vectors)
 	{
-		strong_gens[i] = { Permutation(n) };
+		return level_orbits[i];
 	}
 
-	std::vector<Permutation> gens = generators;
+	vector<int> out;
 
-	while (gens.size() > 0)
+	int b = base_point(i);
+
+	for (int j = 0; j < strong_gens[i].size(); j++)
 	{
-		Permutation g = gens.back();
+		out.push_back(strong_gens[i][j][b]);
+	}
 
-		gens.pop_back();
+	return out;
+}
 
-		std::pair<int, Permutation> new_gen = filter(g);
+bool PermGroup::in_level_orbit(int i, int p) const
+{
+	if (storage == TransversalStorage::schreier_vectors)
+	{
+		return schreier_vectors[i].empty() ? p == base_point(i) : schreier_vectors[i][p] != -1;
+	}
 
-		if (new_gen.first != n - 1)
-		{
-			int i = new_gen.first;
-			Permutation gamma = new_gen.second;
+	return transversal_index[i][p] != -1;
+}
 
-			strong_gens[i].push_back(gamma);
-			num_strong_gens++;
+std::vector<std::vector<int>> PermGroup::level_orbit_labels() const
+{
+	vector<vector<int>> labels(std::max(n - 1, 0));
+	DisjointSets orbits(n);
+	vector<bool> united(schreier_gens.size(), false); //schreier_vectors: a generator is listed at every level it lies in
 
-			for (int j = 0; j <strong_gens.size(); j++)
+	for (int i = n - 2; i >= 0; i--) //the stabilizer at level i is generated by the generators of level i and the levels after it
+	{
+		if (storage == TransversalStorage::schreier_vectors)
+		{
+			for (int j = 0; j < level_gens[i].size(); j++)
 			{
-				std::vector<Permutation> product_set = strong_gens[j] * gamma;
+				int label = level_gens[i][j];
 
-				for (int k = 0; k < product_set.size(); k++)
+				if (united[label])
 				{
-					gens.push_back(product_set[k]);
+					continue;
 				}
-			}
 
-			for (int j = 0; j < strong_gens.size(); j++)
-			{
-				std::vector<Permutation> product_set = gamma * strong_gens[j];
+				united[label] = true;
 
-				for (int k = 0; k < product_set.size(); k++)
+				for (int p = 0; p < n; p++)
 				{
-					gens.push_back(product_set[k]);
+					orbits.unite(p, schreier_gens[label][p]);
+				}
+			}
+		}
+		else
+		{
+			for (int j = 1; j < strong_gens[i].size(); j++)
+			{
+				for (int p = 0; p < n; p++)
+				{
+					orbits.unite(p, strong_gens[i][j][p]);
 				}
 			}
 		}
+
+		labels[i].resize(n);
+
+		for (int p = 0; p < n; p++)
+		{
+			labels[i][p] = orbits.find(p);
+		}
 	}
+
+	return labels;
 }
 
-void PermGroup::fast_schreier_sims()
+Permutation PermGroup::coset_rep(int i, int p) const
 {
-	strong_gens.resize(n - 1);
+	if (storage == TransversalStorage::explicit_transversals)
+	{
+		return strong_gens[i][transversal_index[i][p]];
+	}
 
-	for (int i = 0; i < strong_gens.size(); i++)
+	Permutation u(n);
+
+	while (p != base_point(i)) //walk up the Schreier tree; the label of the edge into p is applied last
 	{
-		strong_gens[i] = { Permutation(n) };
+		int label = schreier_vectors[i][p];
+
+		u = u * schreier_gens[label];
+		p = schreier_gen_inverses[label][p];
 	}
 
-	std::set<Permutation> gens = {};
+	return u;
+}
+
+Permutation PermGroup::coset_rep_inverse(int i, int p) const
+{
+	if (storage == TransversalStorage::explicit_transversals)
+	{
+		return strong_gens[i][transversal_index[i][p]].inverse();
+	}
 
-	gens.insert(generators.begin(), generators.end());
+	Permutation u_inverse(n);
 
-	while (gens.size() > 0)
+	while (p != base_point(i))
 	{
-		Permutation g = *gens.begin();
+		int label = schreier_vectors[i][p];
 
-		gens.erase(gens.begin());
+		u_inverse = schreier_gen_inverses[label] * u_inverse;
+		p = schreier_gen_inverses[label][p];
+	}
 
-		std::pair<int, Permutation> new_gen = filter(g);
+	return u_inverse;
+}
 
-		if (new_gen.first != n - 1)
-		{
-			int i = new_gen.first;
-			Permutation gamma = new_gen.second;
+std::pair<int, Permutation> PermGroup::filter(const Permutation& g, int start_level) const
+{
+	Permutation gamma = g;
 
-			strong_gens[i].push_back(gamma);
-			num_strong_gens++;
+	for (int i = start_level; i < n-1; i++)
+	{
+		int b = base_point(i);
+		int p = gamma[b];
 
-			for (int j = 0; j < strong_gens.size(); j++)
-			{
-				std::vector<Permutation> product_set = strong_gens[j] * gamma;
+		if (p == b) //identity coset rep
+		{
+			continue;
+		}
 
-				for (int k = 0; k < product_set.size(); k++)
-				{
-					gens.insert(product_set[k]);
-				}
-			}
+		if (!in_level_orbit(i, p))
+		{
+			return std::pair<int, Permutation>(i, gamma);
+		}
 
-			for (int j = 0; j < strong_gens.size(); j++)
+		if (storage == TransversalStorage::explicit_transversals)
+		{
+			gamma = strong_gens[i][transversal_index[i][p]].inverse() * gamma;
+		}
+
+		else
+		{
+			while (p != b)
 			{
-				std::vector<Permutation> product_set = gamma * strong_gens[j];
+				int label = schreier_vectors[i][p];
 
-				for (int k = 0; k < product_set.size(); k++)
-				{
-					gens.insert(product_set[k]);
-				}
+				gamma = schreier_gen_inverses[label] * gamma;
+				p = schreier_gen_inverses[label][p];
 			}
 		}
 	}
+	return std::pair<int, Permutation>(n - 1, Permutation(n));
 }
 
-void PermGroup::print_generators()
+void PermGroup::reset_strong_gens()
 {
-	for (int i = 0; i < generators.size(); i++)
+	strong_gens.resize(n - 1);
+	transversal_index.assign(n - 1, vector<int>(n, -1));
+
+	for (int i = 0; i < strong_gens.size(); i++)
 	{
-		generators[i].print();
-		std::cout << ", \n";
+		strong_gens[i] = { Permutation(n) };
+		transversal_index[i][base_point(i)] = 0;
 	}
 }
 
-void PermGroup::print_strong_gens()
+void PermGroup::add_coset_rep(int i, const Permutation& gamma)
 {
+	transversal_index[i][gamma[base_point(i)]] = strong_gens[i].size();
+	strong_gens[i].push_back(gamma);
+}
 
-	if (strong_gens.size() == 0)
-	{
-		fast_schreier_sims();
-	}
+void PermGroup::index_transversals()
+{
+	transversal_index.assign(strong_gens.size(), vector<int>(n, -1));
 
 	for (int i = 0; i < strong_gens.size(); i++)
 	{
-		std::cout << "C_" << i << ":" << std::endl;
+		int b = base_point(i);
 
 		for (int j = 0; j < strong_gens[i].size(); j++)
 		{
-			strong_gens[i][j].print();
-			std::cout << ", \n";
+			transversal_index[i][strong_gens[i][j][b]] = j;
 		}
-		std::cout << '\n';
 	}
 }
 
-bool PermGroup::contains(const Permutation& g)
+void PermGroup::set_base(const std::vector<int>& new_base)
 {
-	if (strong_gens.size() == 0)
+	base.clear();
+
+	for (int i = 0; i < new_base.size(); i++)
 	{
-		fast_schreier_sims();
+		if (new_base[i] != i)
+		{
+			base = new_base;
+			return;
+		}
 	}
-
-	return (filter(g).first == n - 1);
 }
 
-unsigned long long int PermGroup::order()
+void PermGroup::use_standard_base()
 {
-	if (strong_gens.size() == 0)
+	if (base.empty())
 	{
-		fast_schreier_sims();
+		return;
 	}
 
-	unsigned long long int order = 1;
+	base.clear();
 
-	
-	for (int i = 0; i < strong_gens.size(); i++)
+	strong_gens.clear();
+	transversal_index.clear();
+	level_orbits.clear();
+
+	num_strong_gens = 0;
+}
+
+static void add_prime_exponents(int m, std::vector<int>& exponents) //exponents[p] += multiplicity of the prime p in m
+{
+	for (int p = 2; p * p <= m; p++)
 	{
-		order *= strong_gens[i].size();
+		while (m % p == 0)
+		{
+			exponents[p]++;
+			m /= p;
+		}
 	}
-	
 
-	return order; 
+	if (m > 1)
+	{
+		exponents[m]++;
+	}
 }
 
-std::vector<unsigned long long int> PermGroup::order_factors()
+void PermGroup::change_to_standard_base()
 {
-	if (strong_gens.size() == 0)
+	if (base.empty() && has_chain())
 	{
-		fast_schreier_sims();
+		return;
 	}
 
-	std::vector<unsigned long long int> out;
-
-	for (int i = 0; i < strong_gens.size(); i++)
+	if (!has_chain())
 	{
-		out.push_back(strong_gens[i].size());
+		use_standard_base();
+		set_storage(TransversalStorage::schreier_vectors);
+		fast_schreier_sims();
+		return;
 	}
 
-	return out; 
-}
+	PermGroup old = *this;
 
-std::vector<std::set<int>> PermGroup::compute_orbits(std::set<int> s) //Based on solution to Ex. B.2 (Helfgott)
-{
-	std::map<int, std::set<int>> gen_orbits;
+	vector<int> old_exponents(n + 1, 0); //the order as a product of primes; level sizes are at most n, so products of them compare exactly
+	vector<int> exponents(n + 1, 0);
 
-	for (auto i = s.begin(); i != s.end(); i++)
+	for (int i = 0; i < n - 1; i++)
 	{
+		add_prime_exponents(old.level_size(i), old_exponents);
+	}
 
-		std::set<int> gen_set = {*i};
+	base.clear();
+	strong_gens.clear();
+	transversal_index.clear();
+	storage = TransversalStorage::schreier_vectors;
+	install_schreier_gens({});
 
-		for (int j = 0; j < generators.size(); j++)
-		{
-			gen_set.insert(generators[j][*i]);
-		}
+	RandomNumberEngine rand_eng(1);
 
-		/*
-		for (int j = 0; j < strong_gens.size(); j++)
+	while (exponents != old_exponents) //the product of the level sizes is at most the order of the group the chain's generators generate, with equality exactly when the chain is complete
+	{
+		Permutation g(n); //uniformly random: a uniformly random coset rep from each level of the old chain
+
+		for (int i = 0; i < n - 1; i++)
 		{
-			for (int k = 0; k < strong_gens[j].size(); k++)
+			if (old.level_size(i) > 1)
 			{
-				gen_set.insert(strong_gens[j][k][*i]);
+				vector<int> orbit = old.level_orbit(i);
+
+				g = g * old.coset_rep(i, orbit[rand_eng.random_int(0, (int)orbit.size() - 1)]);
 			}
 		}
-		*/
-
-		gen_orbits[*i] = gen_set;
-	}
-
-	std::vector<std::set<int>> out;
 
-	while (!s.empty())
-	{
-		int root = *s.begin();
-
-		s.erase(root);
+		std::pair<int, Permutation> sifted = filter(g);
 
-		std::set<int> orbit = gen_orbits[root];
+		if (sifted.first == n - 1)
+		{
+			continue;
+		}
 
-		std::set<int> unexamined = gen_orbits[root];
+		int l = sifted.first;
 
-		unexamined.erase(root);
+		add_schreier_gen(sifted.second, 0, l);
 
-		while (!unexamined.empty())
+		for (int m = 0; m <= l; m++)
 		{
-			int next = *unexamined.begin();
+			build_schreier_tree(m);
+		}
 
-			unexamined.erase(next);
-			s.erase(next);
+		std::fill(exponents.begin(), exponents.end(), 0);
 
-			for(auto i = gen_orbits[next].begin(); i != gen_orbits[next].end(); i++)
-			{
-				if (!(orbit.count(*i)))
-				{
-					orbit.insert(*i);
-					unexamined.insert(*i);
-				}
-			}
+		for (int i = 0; i < n - 1; i++)
+		{
+			add_prime_exponents(level_size(i), exponents);
 		}
-		out.push_back(orbit);
 	}
-
-	return out; 
 }
-/*
-std::set<int> PermGroup::get_orbit(int a)
-{
-	std::set<int> orbit = { a };
 
-	std::set<int> new_elements = {a};
+std::vector<Permutation> PermGroup::strong_generating_set() const
+{
+	vector<Permutation> out;
 
-	while (!new_elements.empty())
+	if (storage == TransversalStorage::schreier_vectors)
 	{
-		std::set<int> added_elts;
-
-		for (auto i : new_elements)
+		for (int j = 0; j < schreier_gens.size(); j++)
 		{
-			for (int j = 0; j < strong_gens.size(); j++)
+			if (!shortcut[j])
 			{
-				for (int k = 0; k < strong_gens[j].size(); k++)
-				{
-					int new_elt = strong_gens[j][k][i];
-
-					if (!orbit.count(new_elt))
-					{
-						orbit.insert(new_elt);
-						added_elts.insert(new_elt);
-					}
-
-				}
+				out.push_back(schreier_gens[j]);
 			}
-
 		}
 
-		new_elements.clear();
-		new_elements.insert(added_elts.begin(), added_elts.end());
-
+		return out;
 	}
 
-	return orbit; 
+	for (int i = 0; i < strong_gens.size(); i++)
+	{
+		out.insert(out.end(), strong_gens[i].begin() + 1, strong_gens[i].end()); //skip the identity
+	}
 
+	return out;
 }
 
-std::set<std::set<int>> PermGroup::get_orbit(const std::set<int>& s)
+void PermGroup::schreier_sims()
 {
-	std::set<std::set<int>> orbit = { s };
+	reset_strong_gens();
 
-	std::set<std::set<int>> new_elements = { s };
+	std::vector<Permutation> gens = generators;
 
-	while (!new_elements.empty())
+	while (gens.size() > 0)
 	{
-		std::set<std::set<int>> added_elts;
+		Permutation g = gens.back();
 
-		for (auto i : new_elements)
+		gens.pop_back();
+
+		std::pair<int, Permutation> new_gen = filter(g);
+
+		if (new_gen.first != n - 1)
 		{
-			for (int j = 0; j < strong_gens.size(); j++)
+			int i = new_gen.first;
+			Permutation gamma = new_gen.second;
+
+			add_coset_rep(i, gamma);
+			num_strong_gens++;
+
+			for (int j = 0; j <strong_gens.size(); j++)
 			{
-				for (int k = 0; k < strong_gens[j].size(); k++)
+				std::vector<Permutation> product_set = strong_gens[j] * gamma;
+
+				for (int k = 0; k < product_set.size(); k++)
 				{
-					std::set<int> new_elt = strong_gens[j][k][i];
+					gens.push_back(product_set[k]);
+				}
+			}
 
-					if (!orbit.count(new_elt))
-					{
-						orbit.insert(new_elt);
-						added_elts.insert(new_elt);
-					}
+			for (int j = 0; j < strong_gens.size(); j++)
+			{
+				std::vector<Permutation> product_set = gamma * strong_gens[j];
 
+				for (int k = 0; k < product_set.size(); k++)
+				{
+					gens.push_back(product_set[k]);
 				}
 			}
 		}
+	}
+}
 
-		new_elements.clear();
-		new_elements.insert(added_elts.begin(), added_elts.end());
+void PermGroup::fast_schreier_sims()
+{
+	if (storage == TransversalStorage::schreier_vectors)
+	{
+		install_schreier_gens(generators);
+
+		schreier_vector_sims(n - 2);
+
+		return;
 	}
 
-	return orbit;
+	reset_strong_gens();
+
+	extend_strong_gens(std::set<Permutation>(generators.begin(), generators.end()));
 }
-*/
 
-std::vector<std::set<int>> PermGroup::minimal_block_system(const std::set<int>& s)
+class ComputationMonitor //tracks one run of a controlled computation; without a control it never asks to stop or checkpoint
 {
-	std::vector<std::set<int>> initial_blocks;
 
-	for (auto i : s)
+private:
+
+	ComputationControl* control;
+
+	std::chrono::steady_clock::time_point start;
+	std::chrono::steady_clock::time_point last_checkpoint;
+
+	long long work;
+
+	double seconds_since(std::chrono::steady_clock::time_point t) const
 	{
-		initial_blocks.push_back({ i });
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
 	}
 
-	return minimal_block_system(initial_blocks);
-}
+public:
 
-std::vector<std::set<int>> PermGroup::minimal_block_system(const std::vector<std::set<int>>& B) 
-{
-	if (B.empty())
+	ComputationMonitor(ComputationControl* control) :
+		control(control),
+		start(std::chrono::steady_clock::now()),
+		last_checkpoint(start),
+		work(0)
 	{
-		return {};
 	}
 
-	std::set<int> anchor = B[0]; //vertex i of graph will correspond to B[i]
+	bool stop(ComputationStatus& status) //called before each sift
+	{
+		if (control == nullptr)
+		{
+			return false;
+		}
+
+		if (control->cancel)
+		{
+			status = ComputationStatus::cancelled;
+			return true;
+		}
+
+		if ((control->work_budget > 0 && work >= control->work_budget) || (control->time_budget > 0 && seconds_since(start) >= control->time_budget))
+		{
+			status = ComputationStatus::out_of_budget;
+			return true;
+		}
 
-	map<set<int>, int> vertex_map; //maps each block in B to its corresponding vertex in the graph G
+		work++;
 
-	for (int i = 0; i < B.size(); i++)
+		return false;
+	}
+
+	bool checkpoint_due()
 	{
-		vertex_map[B[i]] = i;
+		if (control == nullptr || control->checkpoint_path.empty() || seconds_since(last_checkpoint) < control->checkpoint_interval)
+		{
+			return false;
+		}
+
+		last_checkpoint = std::chrono::steady_clock::now();
+
+		return true;
 	}
 
-	for (int i = 1; i < B.size(); i++)
+	bool checkpointing() const { return control != nullptr && !control->checkpoint_path.empty(); }
+};
+
+ComputationStatus PermGroup::extend_strong_gens(std::set<Permutation> gens, ComputationControl* control)
+{
+	ComputationMonitor monitor(control);
+
+	vector<int> key; //the base the chain is built on
+
+	for (int i = 0; i < n; i++)
 	{
-		Graph G(B.size());
+		key.push_back(base_point(i));
+	}
 
-		set<set<int>> start_edge = {B[0] , B[i]};
-		set<set<set<int>>> edge_orbit = get_orbit(start_edge);
+	while (gens.size() > 0)
+	{
+		ComputationStatus status;
 
-		for (auto j : edge_orbit) //insert each edge into the graph
+		if (monitor.stop(status))
 		{
-			auto k = j.begin();
+			if (monitor.checkpointing())
+			{
+				write_checkpoint(control->checkpoint_path, "schreier_sims", key, strong_gens, gens);
+			}
+
+			return status;
+		}
 
-			set<int> first = *k;
-			k++;
-			set<int> second = *k;
-			
-			G.insert_edge(vertex_map.at(first), vertex_map.at(second));
+		if (monitor.checkpoint_due())
+		{
+			write_checkpoint(control->checkpoint_path, "schreier_sims", key, strong_gens, gens);
 		}
 
-		vector<set<int>> conn_comps = G.conn_components();
+		Permutation g = *gens.begin();
+
+		gens.erase(gens.begin());
+
+		std::pair<int, Permutation> new_gen = filter(g);
 
-		if (conn_comps.size() > 1)
+		if (new_gen.first != n - 1)
 		{
-			vector<set<int>> new_block_sys;
+			int i = new_gen.first;
+			Permutation gamma = new_gen.second;
+
+			add_coset_rep(i, gamma);
+			num_strong_gens++;
 
-			for (int i = 0; i < conn_comps.size(); i++)
+			for (int j = 0; j < strong_gens.size(); j++)
 			{
-				set<int> new_block;
+				std::vector<Permutation> product_set = strong_gens[j] * gamma;
 
-				for (int j : conn_comps[i])
+				for (int k = 0; k < product_set.size(); k++)
 				{
-					new_block.insert(B[j].begin(), B[j].end());
+					gens.insert(product_set[k]);
 				}
+			}
 
-				new_block_sys.push_back(new_block);
+			for (int j = 0; j < strong_gens.size(); j++)
+			{
+				std::vector<Permutation> product_set = gamma * strong_gens[j];
+
+				for (int k = 0; k < product_set.size(); k++)
+				{
+					gens.insert(product_set[k]);
+				}
 			}
+		}
+	}
+
+	return ComputationStatus::completed;
+}
 
-			return minimal_block_system(new_block_sys);
+void PermGroup::write_checkpoint(const std::string& path, const std::string& kind, const std::vector<int>& key, const std::vector<std::vector<Permutation>>& levels, const std::set<Permutation>& pending) const
+{
+	std::string tmp_path = path + ".tmp";
+
+	std::ofstream out(tmp_path);
+
+	auto write_perm = [&out](const Permutation& g)
+	{
+		for (int i = 0; i < g.size(); i++)
+		{
+			out << g[i] << ' ';
 		}
+
+		out << '\n';
+	};
+
+	out << kind << '\n' << n << ' ' << generators.size() << ' ' << key.size() << '\n';
+
+	for (int i = 0; i < key.size(); i++)
+	{
+		out << key[i] << ' ';
 	}
-	
-	return B; //block system was already minimal
+
+	out << '\n';
+
+	for (int j = 0; j < generators.size(); j++)
+	{
+		write_perm(generators[j]);
+	}
+
+	out << levels.size() << '\n';
+
+	for (int i = 0; i < levels.size(); i++)
+	{
+		out << levels[i].size() << '\n';
+
+		for (int j = 0; j < levels[i].size(); j++)
+		{
+			write_perm(levels[i][j]);
+		}
+	}
+
+	out << pending.size() << '\n';
+
+	for (auto g = pending.begin(); g != pending.end(); g++)
+	{
+		write_perm(*g);
+	}
+
+	out.close();
+
+	if (!out)
+	{
+		throw InvalidGroupOperation();
+	}
+
+	std::remove(path.c_str()); //rename does not replace an existing file everywhere
+	std::rename(tmp_path.c_str(), path.c_str());
 }
 
-std::pair<int, Permutation> PermGroup::block_filter(const Permutation& g, const std::vector<std::vector<Permutation>>& current_strong_gens ,const std::vector<std::set<int>>& B)
+void PermGroup::read_checkpoint(const std::string& path, const std::string& kind, const std::vector<int>& key, std::vector<std::vector<Permutation>>& levels, std::set<Permutation>& pending) const
 {
-	Permutation gamma = g;
+	std::ifstream in(path);
 
-	for (int i = 0; i < B.size(); i++)
+	auto read_perm = [&in, this]()
 	{
-		bool found_H_rep = false;
+		vector<int> values(n);
 
-		for (int j = 0; j < current_strong_gens[i].size(); j++)
+		for (int i = 0; i < n; i++)
 		{
-			Permutation h = current_strong_gens[i][j];
+			in >> values[i];
+		}
 
-			if (h[B[i]] == gamma[B[i]])
-			{
-				found_H_rep = true;
-				gamma = h.inverse() * gamma;
+		vector<bool> seen(n, false);
 
-				break;
+		for (int i = 0; i < n && in; i++) //checked here, so a corrupt file is reported like any other bad checkpoint
+		{
+			if (values[i] < 0 || values[i] >= n || seen[values[i]])
+			{
+				throw InvalidGroupOperation();
 			}
+
+			seen[values[i]] = true;
 		}
 
-		if (!found_H_rep)
+		if (!in)
 		{
-			return std::pair<int, Permutation>(i, gamma);
+			throw InvalidGroupOperation();
 		}
+
+		return Permutation(values);
+	};
+
+	std::string file_kind;
+	int file_n = 0;
+	int num_gens = 0;
+	int key_size = 0;
+
+	in >> file_kind >> file_n >> num_gens >> key_size;
+
+	if (!in || file_kind != kind || file_n != n || num_gens != generators.size() || key_size != key.size())
+	{
+		throw InvalidGroupOperation();
 	}
 
-	for (int i = B.size(); i < current_strong_gens.size(); i++)
+	for (int i = 0; i < key_size; i++)
 	{
-		bool found_rep = false;
+		int k = -1;
+		in >> k;
 
-		for (int j = 0; j < current_strong_gens[i].size(); j++)
+		if (k != key[i])
 		{
-			Permutation h = current_strong_gens[i][j];
+			throw InvalidGroupOperation();
+		}
+	}
 
-			if (h[i - B.size()] == gamma[i - B.size()])
-			{
-				found_rep = true;
-				gamma = h.inverse() * gamma;
-				break;
-			}
+	for (int j = 0; j < num_gens; j++)
+	{
+		if (!(read_perm() == generators[j]))
+		{
+			throw InvalidGroupOperation();
 		}
+	}
 
-		if (!found_rep)
+	int num_levels = 0;
+	in >> num_levels;
+
+	levels.assign(num_levels, {});
+
+	for (int i = 0; i < num_levels; i++)
+	{
+		int level_size = 0;
+		in >> level_size;
+
+		for (int j = 0; j < level_size; j++)
 		{
-			return std::pair<int, Permutation>(i, gamma);
+			levels[i].push_back(read_perm());
 		}
 	}
 
-	return std::pair<int, Permutation>(current_strong_gens.size(), Permutation(n)); //g was already a product of strong gens
+	int num_pending = 0;
+	in >> num_pending;
+
+	pending.clear();
+
+	for (int j = 0; j < num_pending; j++)
+	{
+		pending.insert(read_perm());
+	}
+
+	if (!in)
+	{
+		throw InvalidGroupOperation();
+	}
 }
 
-PermGroup PermGroup::block_stabilizer(const std::vector<std::set<int>>& B) 
+ComputationStatus PermGroup::build_chain(ComputationControl& control)
 {
-	//H will be the subgroup of G which fixes all blocks of B
-
-	
-	std::vector<std::vector<Permutation>> H_strong_gens(n + B.size() - 1);
-	
-	/*
-	* m = B.size()
-	* first m-1 entries contains coset reps of G_(i)/G_(i+1), where G_(i) stabilizes first i blocks
-	* middle entry contains coset reps of something 
-	* remaining n-1 entries contain strong generators of H
-	*
-	*
-	*/ 
+	if (storage != TransversalStorage::explicit_transversals)
+	{
+		throw InvalidGroupOperation();
+	}
 
-	for (int i = 0; i < H_strong_gens.size(); i++)
+	if (has_chain())
 	{
-		H_strong_gens[i] = { Permutation(n) };
+		return ComputationStatus::completed;
 	}
 
-	std::set<Permutation> gens(generators.begin(), generators.end());
+	reset_strong_gens();
+	num_strong_gens = 0;
 
-	while (gens.size() > 0)
+	ComputationStatus status = extend_strong_gens(std::set<Permutation>(generators.begin(), generators.end()), &control);
+
+	if (status != ComputationStatus::completed) //a partial chain would give wrong answers
 	{
-		Permutation g = *gens.begin();
+		strong_gens.clear();
+		transversal_index.clear();
+		num_strong_gens = 0;
+	}
 
-		gens.erase(gens.begin());
+	return status;
+}
 
-		std::pair<int, Permutation> new_gen = block_filter(g, H_strong_gens, B);
+template<class F>
+static bool is_coset_chain(const vector<vector<Permutation>>& levels, int num_levels, F image) //image(g, i) = what tells the reps of level i apart, or -1 if g moves something the levels before i fix; each level must start with the identity and tell its reps apart
+{
+	if (levels.size() != num_levels)
+	{
+		return false;
+	}
 
-		if (new_gen.first != H_strong_gens.size())
+	for (int i = 0; i < num_levels; i++)
+	{
+		if (levels[i].empty() || !(levels[i][0] == Permutation(levels[i][0].size())))
 		{
-			int i = new_gen.first;
-			Permutation gamma = new_gen.second;
+			return false;
+		}
 
-			H_strong_gens[i].push_back(gamma);
+		std::set<int> images;
 
-			for (int j = 0; j < H_strong_gens.size(); j++)
+		for (const Permutation& g : levels[i])
+		{
+			int x = image(g, i);
+
+			if (x == -1 || !images.insert(x).second)
 			{
-				std::vector<Permutation> right_product_set = H_strong_gens[j] * gamma;
+				return false;
+			}
+		}
+	}
 
-				std::vector<Permutation> left_product_set = gamma * H_strong_gens[j];
+	return true;
+}
 
-				for (int k = 0; k < right_product_set.size(); k++)
-				{
-					gens.insert(right_product_set[k]);
-				}
+ComputationStatus PermGroup::resume_chain(ComputationControl& control)
+{
+	if (storage != TransversalStorage::explicit_transversals || n < 2)
+	{
+		throw InvalidGroupOperation();
+	}
 
-				for (int k = 0; k < left_product_set.size(); k++)
-				{
-					gens.insert(left_product_set[k]);
-				}
+	vector<int> key;
+
+	for (int i = 0; i < n; i++)
+	{
+		key.push_back(base_point(i));
+	}
+
+	vector<vector<Permutation>> levels; //installed only once read and checked, so a bad checkpoint leaves the group as it was
+	std::set<Permutation> pending;
+
+	read_checkpoint(control.checkpoint_path, "schreier_sims", key, levels, pending);
+
+	auto image = [this](const Permutation& g, int i)
+	{
+		for (int j = 0; j < i; j++)
+		{
+			if (g[base_point(j)] != base_point(j))
+			{
+				return -1;
 			}
 		}
-	}
 
-	std::vector<std::vector<Permutation>> final_strong_gens;
+		return g[base_point(i)];
+	};
 
-	for (int i = B.size(); i < H_strong_gens.size(); i++)
+	if (!is_coset_chain(levels, n - 1, image))
 	{
-		final_strong_gens.push_back(H_strong_gens[i]);
+		throw InvalidGroupOperation();
 	}
 
-	return PermGroup(final_strong_gens);
+	strong_gens.swap(levels);
+	index_transversals();
+
+	num_strong_gens = 0;
+
+	for (int i = 0; i < n - 1; i++)
+	{
+		num_strong_gens += strong_gens[i].size() - 1;
+	}
+
+	ComputationStatus status = extend_strong_gens(pending, &control);
+
+	if (status != ComputationStatus::completed)
+	{
+		strong_gens.clear();
+		transversal_index.clear();
+		num_strong_gens = 0;
+	}
+
+	return status;
+}
+
+void PermGroup::install_schreier_gens(const std::vector<Permutation>& S)
+{
+	schreier_gens.clear();
+	schreier_gen_inverses.clear();
+	shortcut.clear();
+	level_gens.assign(n - 1, {});
+	schreier_vectors.assign(n - 1, {});
+	level_orbits.assign(n - 1, {});
+
+	for (int i = 0; i < n - 1; i++)
+	{
+		level_orbits[i] = { base_point(i) };
+	}
+
+	for (int j = 0; j < S.size(); j++)
+	{
+		int first_moved = 0;
+
+		while (first_moved < n && S[j][base_point(first_moved)] == base_point(first_moved))
+		{
+			first_moved++;
+		}
+
+		if (first_moved < n)
+		{
+			add_schreier_gen(S[j], 0, first_moved);
+		}
+	}
+
+	for (int i = 0; i < n - 1; i++)
+	{
+		build_schreier_tree(i);
+	}
+}
+
+void PermGroup::add_schreier_gen(const Permutation& g, int first_level, int last_level, bool is_shortcut)
+{
+	int label = schreier_gens.size();
+
+	schreier_gens.push_back(g);
+	schreier_gen_inverses.push_back(g.inverse());
+	shortcut.push_back(is_shortcut);
+
+	for (int i = first_level; i <= last_level && i < n - 1; i++)
+	{
+		level_gens[i].push_back(label);
+	}
+
+	num_strong_gens = schreier_gens.size();
+}
+
+void PermGroup::build_schreier_tree(int i)
+{
+	int root = base_point(i);
+
+	if (level_gens[i].empty())
+	{
+		schreier_vectors[i].clear();
+		level_orbits[i] = { root };
+
+		return;
+	}
+
+	while (true)
+	{
+		vector<int>& labels = schreier_vectors[i];
+		vector<int>& orbit = level_orbits[i];
+
+		labels.assign(n, -1);
+		labels[root] = -2;
+		orbit = { root };
+
+		vector<int> depth(n, 0);
+
+		for (int k = 0; k < orbit.size(); k++) //BFS, so orbit.back() is a deepest point
+		{
+			int p = orbit[k];
+
+			for (int j = 0; j < level_gens[i].size(); j++)
+			{
+				int q = schreier_gens[level_gens[i][j]][p];
+
+				if (labels[q] == -1)
+				{
+					labels[q] = level_gens[i][j];
+					depth[q] = depth[p] + 1;
+					orbit.push_back(q);
+				}
+			}
+		}
+
+		int max_depth = 1;
+
+		while ((1 << (max_depth / 2)) < orbit.size())
+		{
+			max_depth += 2;
+		}
+
+		if (depth[orbit.back()] <= max_depth)
+		{
+			return;
+		}
+
+		add_schreier_gen(coset_rep(i, orbit.back()), i, i, true); //shortcut straight to the deepest point
+	}
+}
+
+void PermGroup::schreier_vector_sims(int start_level)
+{
+	int i = start_level;
+
+	while (i >= 0) //levels below i are complete: their generators generate the stabilizers of the base points
+	{
+		bool extended = false;
+
+		for (int k = 0; k < level_orbits[i].size() && !extended; k++)
+		{
+			int p = level_orbits[i][k];
+
+			Permutation u_p = coset_rep(i, p);
+
+			for (int j = 0; j < level_gens[i].size(); j++)
+			{
+				if (shortcut[level_gens[i][j]])
+				{
+					continue;
+				}
+
+				const Permutation& s = schreier_gens[level_gens[i][j]];
+
+				Permutation schreier_gen = coset_rep_inverse(i, s[p]) * s * u_p;
+
+				std::pair<int, Permutation> sifted = filter(schreier_gen, i + 1);
+
+				if (sifted.first != n - 1)
+				{
+					int l = sifted.first;
+
+					add_schreier_gen(sifted.second, i + 1, l);
+
+					for (int m = i + 1; m <= l; m++)
+					{
+						build_schreier_tree(m);
+					}
+
+					i = l;
+					extended = true;
+					break;
+				}
+			}
+		}
+
+		if (!extended)
+		{
+			i--;
+		}
+	}
+}
+
+PermGroup PermGroup::conjugate(const Permutation& pi)
+{
+	if (pi.size() != n)
+	{
+		throw InvalidGroupOperation();
+	}
+
+	if (!has_chain())
+	{
+		fast_schreier_sims();
+	}
+
+	Permutation pi_inverse = pi.inverse();
+
+	PermGroup K(pi * generators * pi_inverse, storage);
+
+	vector<int> K_base(n);
+
+	for (int i = 0; i < n; i++)
+	{
+		K_base[i] = pi[base_point(i)];
+	}
+
+	K.set_base(K_base);
+	K.num_strong_gens = num_strong_gens;
+
+	if (storage == TransversalStorage::explicit_transversals)
+	{
+		K.strong_gens.resize(strong_gens.size());
+
+		for (int i = 0; i < strong_gens.size(); i++)
+		{
+			K.strong_gens[i] = pi * strong_gens[i] * pi_inverse;
+		}
+
+		K.index_transversals();
+
+		return K;
+	}
+
+	K.schreier_gens = pi * schreier_gens * pi_inverse;
+	K.schreier_gen_inverses = pi * schreier_gen_inverses * pi_inverse;
+	K.shortcut = shortcut;
+	K.level_gens = level_gens;
+	K.schreier_vectors.resize(schreier_vectors.size());
+	K.level_orbits.resize(level_orbits.size());
+
+	for (int i = 0; i < level_orbits.size(); i++)
+	{
+		for (int k = 0; k < level_orbits[i].size(); k++)
+		{
+			K.level_orbits[i].push_back(pi[level_orbits[i][k]]);
+		}
+
+		if (!schreier_vectors[i].empty())
+		{
+			K.schreier_vectors[i].resize(n);
+
+			for (int p = 0; p < n; p++)
+			{
+				K.schreier_vectors[i][pi[p]] = schreier_vectors[i][p];
+			}
+		}
+	}
+
+	return K;
+}
+
+void PermGroup::reduce_generators(bool complete)
+{
+	if (generators.size() <= 1)
+	{
+		return;
+	}
+
+	PermGroup K(n); //subgroup generated by the kept generators; Schreier vectors keep the incremental updates cheap
+	K.set_storage(TransversalStorage::schreier_vectors);
+	K.fast_schreier_sims();
+
+	vector<Permutation> kept;
+
+	for (int j = 0; j < generators.size(); j++)
+	{
+		std::pair<int, Permutation> sifted = K.filter(generators[j]);
+
+		if (sifted.first == n - 1)
+		{
+			continue;
+		}
+
+		if (complete)
+		{
+			K.add_generator(generators[j]);
+		}
+
+		else //the residue joins the chain as add_generator would place it, but the chain is not closed under Schreier generators; it still only holds elements of <kept>
+		{
+			int l = sifted.first;
+
+			K.add_schreier_gen(sifted.second, 0, l);
+
+			for (int m = 0; m <= l; m++)
+			{
+				K.build_schreier_tree(m);
+			}
+		}
+
+		kept.push_back(generators[j]);
+	}
+
+	if (kept.empty()) //trivial group
+	{
+		kept.push_back(Permutation(n));
+	}
+
+	generators = kept; //the chain, if any, describes the same group and stays valid
+	random_state.clear();
+}
+
+void PermGroup::add_generator(const Permutation& g)
+{
+	if (g.size() != n)
+	{
+		throw InvalidGenerators();
+	}
+
+	generators.push_back(g);
+	random_state.clear();
+
+	if (!has_chain())
+	{
+		return;
+	}
+
+	if (storage == TransversalStorage::explicit_transversals)
+	{
+		extend_strong_gens({ g });
+		return;
+	}
+
+	std::pair<int, Permutation> sifted = filter(g);
+
+	if (sifted.first != n - 1)
+	{
+		int l = sifted.first;
+
+		add_schreier_gen(sifted.second, 0, l);
+
+		for (int m = 0; m <= l; m++)
+		{
+			build_schreier_tree(m);
+		}
+
+		schreier_vector_sims(l);
+	}
+}
+
+void PermGroup::print_generators()
+{
+	for (int i = 0; i < generators.size(); i++)
+	{
+		generators[i].print();
+		std::cout << ", \n";
+	}
+}
+
+void PermGroup::print_strong_gens()
+{
+
+	if (!has_chain())
+	{
+		fast_schreier_sims();
+	}
+
+	for (int i = 0; i < n - 1; i++)
+	{
+		std::cout << "C_" << i << ":" << std::endl;
+
+		if (storage == TransversalStorage::schreier_vectors)
+		{
+			for (int j = 0; j < level_gens[i].size(); j++)
+			{
+				schreier_gens[level_gens[i][j]].print();
+				std::cout << ", \n";
+			}
+		}
+
+		else
+		{
+			for (int j = 0; j < strong_gens[i].size(); j++)
+			{
+				strong_gens[i][j].print();
+				std::cout << ", \n";
+			}
+		}
+		std::cout << '\n';
+	}
+}
+
+bool PermGroup::contains(const Permutation& g)
+{
+	if (!has_chain())
+	{
+		fast_schreier_sims();
+	}
+
+	return (filter(g).first == n - 1);
+}
+
+Permutation PermGroup::min_coset_rep(const Permutation& g)
+{
+	if (g.size() != n)
+	{
+		throw InvalidGroupOperation();
+	}
+
+	use_standard_base(); //the order compares images of 0, 1, ... in turn, so the chain must fix them in that order
+
+	if (!has_chain())
+	{
+		fast_schreier_sims();
+	}
+
+	Permutation x = g;
+
+	for (int i = 0; i < n - 1; i++) //x H^(i) = gH, and x is already minimal on 0, ... , i-1
+	{
+		if (level_size(i) == 1)
+		{
+			continue;
+		}
+
+		vector<int> orbit = level_orbit(i);
+
+		int best = i;
+
+		for (int j = 0; j < orbit.size(); j++) //x * u maps i to x[orbit[j]] for the coset rep u with u[i] = orbit[j]
+		{
+			if (x[orbit[j]] < x[best])
+			{
+				best = orbit[j];
+			}
+		}
+
+		if (best != i)
+		{
+			x = x * coset_rep(i, best);
+		}
+	}
+
+	return x;
+}
+
+std::vector<int> PermGroup::min_image(const std::vector<int>& v)
+{
+	if (v.size() != n)
+	{
+		throw InvalidGroupOperation();
+	}
+
+	use_standard_base();
+
+	if (!has_chain())
+	{
+		fast_schreier_sims();
+	}
+
+	set<vector<int>> candidates = { v }; //images v * x already minimal on positions 0, ... , i-1; equal images reached along different paths are kept once
+
+	for (int i = 0; i < n - 1; i++)
+	{
+		if (level_size(i) == 1)
+		{
+			continue;
+		}
+
+		vector<int> orbit = level_orbit(i);
+
+		int best = v[0];
+		bool found = false;
+
+		for (auto y = candidates.begin(); y != candidates.end(); y++)
+		{
+			for (int j = 0; j < orbit.size(); j++)
+			{
+				if (!found || (*y)[orbit[j]] < best)
+				{
+					best = (*y)[orbit[j]];
+					found = true;
+				}
+			}
+		}
+
+		map<int, Permutation> reps; //coset reps of this level, computed once each
+		set<vector<int>> next;
+
+		for (auto y = candidates.begin(); y != candidates.end(); y++)
+		{
+			for (int j = 0; j < orbit.size(); j++)
+			{
+				if ((*y)[orbit[j]] != best)
+				{
+					continue;
+				}
+
+				if (!reps.count(orbit[j]))
+				{
+					reps.emplace(orbit[j], coset_rep(i, orbit[j]));
+				}
+
+				const Permutation& u = reps.at(orbit[j]);
+
+				vector<int> image(n);
+
+				for (int k = 0; k < n; k++)
+				{
+					image[k] = (*y)[u[k]];
+				}
+
+				next.insert(image);
+			}
+		}
+
+		candidates = next;
+	}
+
+	return *candidates.begin();
+}
+
+unsigned long long int PermGroup::order()
+{
+	if (!has_chain())
+	{
+		fast_schreier_sims();
+	}
+
+	unsigned long long int order = 1;
+
+	
+	for (int i = 0; i < n - 1; i++)
+	{
+		order *= level_size(i);
+	}
+	
+
+	return order; 
+}
+
+std::vector<unsigned long long int> PermGroup::order_factors()
+{
+	if (!has_chain())
+	{
+		fast_schreier_sims();
+	}
+
+	std::vector<unsigned long long int> out;
+
+	for (int i = 0; i < n - 1; i++)
+	{
+		out.push_back(level_size(i));
+	}
+
+	return out; 
+}
+
+bool PermGroup::in_orbit(int a, int b) const
+{
+	return OrbitStream(*this, a).contains(b);
+}
+
+std::vector<std::set<int>> PermGroup::compute_orbits(std::set<int> s) //Based on solution to Ex. B.2 (Helfgott)
+{
+	std::map<int, std::set<int>> gen_orbits;
+
+	for (auto i = s.begin(); i != s.end(); i++)
+	{
+
+		std::set<int> gen_set = {*i};
+
+		for (int j = 0; j < generators.size(); j++)
+		{
+			gen_set.insert(generators[j][*i]);
+		}
+
+		/*
+		for (int j = 0; j < strong_gens.size(); j++)
+		{
+			for (int k = 0; k < strong_gens[j].size(); k++)
+			{
+				gen_set.insert(strong_gens[j][k][*i]);
+			}
+		}
+		*/
+
+		gen_orbits[*i] = gen_set;
+	}
+
+	std::vector<std::set<int>> out;
+
+	while (!s.empty())
+	{
+		int root = *s.begin();
+
+		s.erase(root);
+
+		std::set<int> orbit = gen_orbits[root];
+
+		std::set<int> unexamined = gen_orbits[root];
+
+		unexamined.erase(root);
+
+		while (!unexamined.empty())
+		{
+			int next = *unexamined.begin();
+
+			unexamined.erase(next);
+			s.erase(next);
+
+			for(auto i = gen_orbits[next].begin(); i != gen_orbits[next].end(); i++)
+			{
+				if (!(orbit.count(*i)))
+				{
+					orbit.insert(*i);
+					unexamined.insert(*i);
+				}
+			}
+		}
+		out.push_back(orbit);
+	}
+
+	return out; 
+}
+/*
+std::set<int> PermGroup::get_orbit(int a)
+{
+	std::set<int> orbit = { a };
+
+	std::set<int> new_elements = {a};
+
+	while (!new_elements.empty())
+	{
+		std::set<int> added_elts;
+
+		for (auto i : new_elements)
+		{
+			for (int j = 0; j < strong_gens.size(); j++)
+			{
+				for (int k = 0; k < strong_gens[j].size(); k++)
+				{
+					int new_elt = strong_gens[j][k][i];
+
+					if (!orbit.count(new_elt))
+					{
+						orbit.insert(new_elt);
+						added_elts.insert(new_elt);
+					}
+
+				}
+			}
+
+		}
+
+		new_elements.clear();
+		new_elements.insert(added_elts.begin(), added_elts.end());
+
+	}
+
+	return orbit; 
+
+}
+
+std::set<std::set<int>> PermGroup::get_orbit(const std::set<int>& s)
+{
+	std::set<std::set<int>> orbit = { s };
+
+	std::set<std::set<int>> new_elements = { s };
+
+	while (!new_elements.empty())
+	{
+		std::set<std::set<int>> added_elts;
+
+		for (auto i : new_elements)
+		{
+			for (int j = 0; j < strong_gens.size(); j++)
+			{
+				for (int k = 0; k < strong_gens[j].size(); k++)
+				{
+					std::set<int> new_elt = strong_gens[j][k][i];
+
+					if (!orbit.count(new_elt))
+					{
+						orbit.insert(new_elt);
+						added_elts.insert(new_elt);
+					}
+
+				}
+			}
+		}
+
+		new_elements.clear();
+		new_elements.insert(added_elts.begin(), added_elts.end());
+	}
+
+	return orbit;
+}
+*/
+
+BlockSystem PermGroup::minimal_block_system(const std::set<int>& s)
+{
+	vector<int> singletons(n, -1);
+
+	for (auto i : s)
+	{
+		singletons[i] = i;
+	}
+
+	return minimal_block_system(BlockSystem(singletons));
+}
+
+void PermGroup::merge_blocks(DisjointSets& classes, const std::vector<std::pair<int, int>>& pairs)
+{
+	std::queue<std::pair<int, int>> merged; //(absorbed representative, representative it was absorbed into)
+
+	for (auto pair : pairs)
+	{
+		int absorbed = classes.unite(pair.first, pair.second);
+
+		if (absorbed != -1)
+		{
+			merged.push({ absorbed, classes.find(pair.first) });
+		}
+	}
+
+	while (!merged.empty()) //each representative is absorbed at most once, so this runs at most n-1 times
+	{
+		std::pair<int, int> next = merged.front();
+		merged.pop();
+
+		for (int j = 0; j < generators.size(); j++)
+		{
+			int image_a = generators[j][next.first];
+			int image_b = generators[j][next.second];
+
+			int absorbed = classes.unite(image_a, image_b);
+
+			if (absorbed != -1)
+			{
+				merged.push({ absorbed, classes.find(image_a) });
+			}
+		}
+	}
+}
+
+BlockSystem PermGroup::minimal_block_system(const BlockSystem& B) 
+{
+	if (B.degree() != n)
+	{
+		throw InvalidGroupOperation();
+	}
+
+	BlockSystem current = B;
+
+	for (int i = 1; i < current.size(); i++)
+	{
+		DisjointSets classes(n);
+
+		vector<std::pair<int, int>> pairs;
+
+		for (int p = 0; p < n; p++)
+		{
+			if (current.block(p) != -1)
+			{
+				pairs.push_back({ current.first(current.block(p)), p });
+			}
+		}
+
+		pairs.push_back({ current.first(0), current.first(i) });
+
+		merge_blocks(classes, pairs);
+
+		vector<int> labels(n, -1); //points outside current stay outside
+
+		for (int p = 0; p < n; p++)
+		{
+			if (current.block(p) != -1)
+			{
+				labels[p] = classes.find(p);
+			}
+		}
+
+		BlockSystem new_block_sys(labels);
+
+		if (new_block_sys.size() > 1) //current[0] and current[i] generate a smaller non-trivial system; start over from it
+		{
+			current = new_block_sys;
+			i = 0;
+		}
+	}
+	
+	return current; //block system was already minimal
+}
+
+BlockSystem PermGroup::minimal_block_system(int a, int b)
+{
+	if (a < 0 || a >= n || b < 0 || b >= n)
+	{
+		throw InvalidGroupOperation();
+	}
+
+	DisjointSets classes(n);
+
+	merge_blocks(classes, { { a, b } });
+
+	return BlockSystem(classes.labels());
+}
+
+std::vector<BlockSystem> PermGroup::minimal_block_systems(int a)
+{
+	std::set<BlockSystem> found;
+	vector<BlockSystem> out;
+
+	for (int b = 0; b < n; b++)
+	{
+		if (b == a)
+		{
+			continue;
+		}
+
+		BlockSystem block_sys = minimal_block_system(a, b);
+
+		if (!found.count(block_sys))
+		{
+			found.insert(block_sys);
+			out.push_back(block_sys);
+		}
+	}
+
+	return out;
+}
+
+bool PermGroup::is_transitive()
+{
+	if (n == 0) //no point to start the search from
+	{
+		return true;
+	}
+
+	vector<bool> reached(n, false);
+	std::queue<int> Q;
+
+	reached[0] = true;
+	Q.push(0);
+
+	int num_reached = 1;
+
+	while (!Q.empty())
+	{
+		int current = Q.front();
+		Q.pop();
+
+		for (int j = 0; j < generators.size(); j++)
+		{
+			int image = generators[j][current];
+
+			if (!reached[image])
+			{
+				reached[image] = true;
+				num_reached++;
+				Q.push(image);
+			}
+		}
+	}
+
+	return num_reached == n;
+}
+
+bool PermGroup::is_primitive()
+{
+	if (!is_transitive())
+	{
+		return false;
+	}
+
+	for (int b = 1; b < n; b++)
+	{
+		DisjointSets classes(n);
+
+		merge_blocks(classes, { { 0, b } });
+
+		if (classes.sets() > 1)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::pair<int, Permutation> PermGroup::block_filter(const Permutation& g, const std::vector<std::vector<Permutation>>& current_strong_gens, const BlockSystem& B)
+{
+	Permutation gamma = g;
+
+	for (int i = 0; i < B.size(); i++)
+	{
+		bool found_H_rep = false;
+
+		for (int j = 0; j < current_strong_gens[i].size(); j++)
+		{
+			Permutation h = current_strong_gens[i][j];
+
+			if (B.block(h[B.first(i)]) == B.block(gamma[B.first(i)])) //both map block i to a block, so one point decides which
+			{
+				found_H_rep = true;
+				gamma = h.inverse() * gamma;
+
+				break;
+			}
+		}
+
+		if (!found_H_rep)
+		{
+			return std::pair<int, Permutation>(i, gamma);
+		}
+	}
+
+	for (int i = B.size(); i < current_strong_gens.size(); i++)
+	{
+		bool found_rep = false;
+
+		for (int j = 0; j < current_strong_gens[i].size(); j++)
+		{
+			Permutation h = current_strong_gens[i][j];
+
+			if (h[i - B.size()] == gamma[i - B.size()])
+			{
+				found_rep = true;
+				gamma = h.inverse() * gamma;
+				break;
+			}
+		}
+
+		if (!found_rep)
+		{
+			return std::pair<int, Permutation>(i, gamma);
+		}
+	}
+
+	return std::pair<int, Permutation>(current_strong_gens.size(), Permutation(n)); //g was already a product of strong gens
+}
+
+PermGroup PermGroup::block_stabilizer(const BlockSystem& B) 
+{
+	//H will be the subgroup of G which fixes all blocks of B
+
+	
+	std::vector<std::vector<Permutation>> H_strong_gens(n + B.size() - 1);
+	
+	/*
+	* m = B.size()
+	* first m-1 entries contains coset reps of G_(i)/G_(i+1), where G_(i) stabilizes first i blocks
+	* middle entry contains coset reps of something 
+	* remaining n-1 entries contain strong generators of H
+	*
+	*
+	*/ 
+
+	for (int i = 0; i < H_strong_gens.size(); i++)
+	{
+		H_strong_gens[i] = { Permutation(n) };
+	}
+
+	std::set<Permutation> gens(generators.begin(), generators.end());
+
+	block_stabilizer_closure(B, H_strong_gens, gens, nullptr);
+
+	return block_stabilizer_result(B, H_strong_gens);
+}
+
+std::pair<ComputationStatus, PermGroup> PermGroup::block_stabilizer(const BlockSystem& B, ComputationControl& control)
+{
+	std::vector<std::vector<Permutation>> H_strong_gens(n + B.size() - 1, { Permutation(n) });
+	std::set<Permutation> gens(generators.begin(), generators.end());
+
+	ComputationStatus status = block_stabilizer_closure(B, H_strong_gens, gens, &control);
+
+	if (status != ComputationStatus::completed)
+	{
+		return { status, PermGroup(n) };
+	}
+
+	return { status, block_stabilizer_result(B, H_strong_gens) };
+}
+
+std::pair<ComputationStatus, PermGroup> PermGroup::resume_block_stabilizer(const BlockSystem& B, ComputationControl& control)
+{
+	std::vector<std::vector<Permutation>> H_strong_gens;
+	std::set<Permutation> gens;
+
+	read_checkpoint(control.checkpoint_path, "block_stabilizer", B.labels(), H_strong_gens, gens);
+
+	auto image = [&B](const Permutation& g, int i) //block_filter's levels: blocks first, then points, each level's reps fixing everything before it
+	{
+		for (int j = 0; j < std::min(i, B.size()); j++)
+		{
+			if (B.block(g[B.first(j)]) != j)
+			{
+				return -1;
+			}
+		}
+
+		if (i < B.size())
+		{
+			return B.block(g[B.first(i)]);
+		}
+
+		for (int p = 0; p < i - B.size(); p++)
+		{
+			if (g[p] != p)
+			{
+				return -1;
+			}
+		}
+
+		return g[i - B.size()];
+	};
+
+	if (!is_coset_chain(H_strong_gens, n + B.size() - 1, image))
+	{
+		throw InvalidGroupOperation();
+	}
+
+	ComputationStatus status = block_stabilizer_closure(B, H_strong_gens, gens, &control);
+
+	if (status != ComputationStatus::completed)
+	{
+		return { status, PermGroup(n) };
+	}
+
+	return { status, block_stabilizer_result(B, H_strong_gens) };
+}
+
+ComputationStatus PermGroup::block_stabilizer_closure(const BlockSystem& B, std::vector<std::vector<Permutation>>& H_strong_gens, std::set<Permutation>& gens, ComputationControl* control)
+{
+	ComputationMonitor monitor(control);
+
+	while (gens.size() > 0)
+	{
+		ComputationStatus status;
+
+		if (monitor.stop(status))
+		{
+			if (monitor.checkpointing())
+			{
+				write_checkpoint(control->checkpoint_path, "block_stabilizer", B.labels(), H_strong_gens, gens);
+			}
+
+			return status;
+		}
+
+		if (monitor.checkpoint_due())
+		{
+			write_checkpoint(control->checkpoint_path, "block_stabilizer", B.labels(), H_strong_gens, gens);
+		}
+
+		Permutation g = *gens.begin();
+
+		gens.erase(gens.begin());
+
+		std::pair<int, Permutation> new_gen = block_filter(g, H_strong_gens, B);
+
+		if (new_gen.first != H_strong_gens.size())
+		{
+			int i = new_gen.first;
+			Permutation gamma = new_gen.second;
+
+			H_strong_gens[i].push_back(gamma);
+
+			for (int j = 0; j < H_strong_gens.size(); j++)
+			{
+				std::vector<Permutation> right_product_set = H_strong_gens[j] * gamma;
+
+				std::vector<Permutation> left_product_set = gamma * H_strong_gens[j];
+
+				for (int k = 0; k < right_product_set.size(); k++)
+				{
+					gens.insert(right_product_set[k]);
+				}
+
+				for (int k = 0; k < left_product_set.size(); k++)
+				{
+					gens.insert(left_product_set[k]);
+				}
+			}
+		}
+	}
+
+	return ComputationStatus::completed;
+}
+
+PermGroup PermGroup::block_stabilizer_result(const BlockSystem& B, const std::vector<std::vector<Permutation>>& H_strong_gens) const
+{
+	std::vector<std::vector<Permutation>> final_strong_gens;
+
+	for (int i = B.size(); i < H_strong_gens.size(); i++)
+	{
+		final_strong_gens.push_back(H_strong_gens[i]);
+	}
+
+	PermGroup H(final_strong_gens);
+	H.reduce_generators();
+
+	return H;
+}
+
+bool PermGroup::is_trivial() const
+{
+	for (int i = 0; i < generators.size(); i++)
+	{
+		if (!(generators[i] == Permutation(n)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+PermGroup PermGroup::normal_closure(const std::vector<Permutation>& S)
+{
+	PermGroup N(n);
+
+	std::vector<Permutation> unconjugated; //elements of N whose conjugates by generators of G have not been checked yet
+
+	for (int i = 0; i < S.size(); i++)
+	{
+		if (!N.contains(S[i]))
+		{
+			N.add_generator(S[i]);
+			unconjugated.push_back(S[i]);
+		}
+	}
+
+	while (!unconjugated.empty())
+	{
+		Permutation x = unconjugated.back();
+		unconjugated.pop_back();
+
+		for (int j = 0; j < generators.size(); j++)
+		{
+			Permutation conjugate = generators[j] * x * generators[j].inverse();
+
+			if (!N.contains(conjugate))
+			{
+				N.add_generator(conjugate);
+				unconjugated.push_back(conjugate);
+			}
+		}
+	}
+
+	return N;
+}
+
+PermGroup PermGroup::derived_subgroup()
+{
+	std::vector<Permutation> commutators;
+
+	for (int i = 0; i < generators.size(); i++)
+	{
+		for (int j = i + 1; j < generators.size(); j++)
+		{
+			commutators.push_back(generators[i].inverse() * generators[j].inverse() * generators[i] * generators[j]);
+		}
+	}
+
+	return normal_closure(commutators);
+}
+
+std::vector<PermGroup> PermGroup::derived_series()
+{
+	std::vector<PermGroup> series = { *this };
+
+	while (!series.back().is_trivial())
+	{
+		PermGroup next = series.back().derived_subgroup();
+
+		if (next.order_factors() == series.back().order_factors()) //G^(k+1) <= G^(k) with the same order, so G^(k) is perfect
+		{
+			break;
+		}
+
+		series.push_back(next);
+	}
+
+	return series;
+}
+
+bool PermGroup::is_solvable()
+{
+	return derived_series().back().is_trivial();
+}
+
+static bool is_prime(int p)
+{
+	if (p < 2)
+	{
+		return false;
+	}
+
+	for (int d = 2; d * d <= p; d++)
+	{
+		if (p % d == 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+Permutation PermGroup::random_element(RandomNumberEngine& rand_eng)
+{
+	if (random_state.empty())
+	{
+		int r = std::max<int>(10, generators.size());
+
+		for (int i = 0; i < r; i++)
+		{
+			random_state.push_back(generators[i % generators.size()]);
+		}
+
+		random_state.push_back(Permutation(n)); //accumulator
+
+		for (int i = 0; i < 50; i++) //scramble the initial state
+		{
+			random_element(rand_eng);
+		}
+	}
+
+	int r = random_state.size() - 1;
+	int i = rand_eng.random_int(0, r - 1);
+	int j = rand_eng.random_int(0, r - 2);
+
+	if (j >= i)
+	{
+		j++;
+	}
+
+	random_state[i] = random_state[i] * (rand_eng.random_int() ? random_state[j] : random_state[j].inverse());
+	random_state[r] = random_state[r] * random_state[i];
+
+	return random_state[r];
+}
+
+bool PermGroup::is_giant(RandomNumberEngine& rand_eng, double error)
+{
+	if (n < 8) //there is no prime strictly between n/2 and n-2, so compare orders; these are at most 5040
+	{
+		unsigned long long int factorial = 1;
+
+		for (int i = 2; i <= n; i++)
+		{
+			factorial *= i;
+		}
+
+		unsigned long long int G_order = order();
+
+		return G_order == factorial || 2 * G_order == factorial;
+	}
+
+	if (!is_transitive())
+	{
+		return false;
+	}
+
+	//Jordan: a primitive group containing a p-cycle, p prime and p <= n-3, contains Alt(n). An element with a p-cycle for n/2 < p has a power which is that p-cycle,
+	//and a transitive group containing such a p-cycle is already primitive (a block meeting the cycle would have to contain all of it), so primitivity needs no separate check.
+	//In Alt(n) and Sym(n) a proportion 1/p of the elements have a p-cycle, for each such p.
+
+	double proportion = 0;
+
+	for (int p = n / 2 + 1; p < n - 2; p++)
+	{
+		if (is_prime(p))
+		{
+			proportion += 1.0 / p;
+		}
+	}
+
+	int samples = std::ceil(std::log(1 / error) / proportion);
+
+	for (int s = 0; s < samples; s++)
+	{
+		std::vector<int> cycles = random_element(rand_eng).cycle_lengths();
+
+		for (int i = 0; i < cycles.size(); i++)
+		{
+			if (2 * cycles[i] > n && cycles[i] < n - 2 && is_prime(cycles[i]))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+std::pair<bool, GiantHomomorphism> PermGroup::giant_homomorphism(const BlockSystem& B, RandomNumberEngine& rand_eng, double error)
+{
+	if (B.degree() != n)
+	{
+		throw InvalidGroupOperation();
+	}
+
+	GiantHomomorphism phi = { B, true };
+
+	vector<Permutation> images;
+
+	for (int i = 0; i < generators.size(); i++)
+	{
+		images.push_back(phi(generators[i]));
+
+		if (!images.back().is_even())
+		{
+			phi.alternating = false;
+		}
+	}
+
+	PermGroup action(images);
+
+	return { action.is_giant(rand_eng, error), phi };
+}
+
+Permutation GiantHomomorphism::operator()(const Permutation& g) const
+{
+	vector<int> image(blocks.size());
+
+	for (int b = 0; b < blocks.size(); b++)
+	{
+		image[b] = blocks.block(g[blocks.first(b)]);
+	}
+
+	return Permutation(image);
+}
+
+static unsigned long long mix_bits(unsigned long long z) //splitmix64 finalizer
+{
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+	return z ^ (z >> 31);
+}
+
+//For each block of each system, a hash of the multiset of pairs (G_labels[G_side[q]], H_labels[H_side[q]]) over its points q, sorted within each system.
+//Equal multisets hash alike, so differing results prove that no permutation matches the blocks up; a collision can only keep a dead branch.
+static vector<unsigned long long> block_patterns(const vector<BlockSystem>& systems, const vector<int>& G_labels, const vector<int>& H_labels, const Permutation& G_side, const Permutation& H_side)
+{
+	unsigned long long n = G_labels.size();
+
+	vector<unsigned long long> out;
+
+	for (int s = 0; s < systems.size(); s++)
+	{
+		int first = out.size();
+
+		for (int b = 0; b < systems[s].size(); b++)
+		{
+			unsigned long long pattern = 0;
+
+			for (const int* q = systems[s].begin(b); q != systems[s].end(b); q++)
+			{
+				pattern += mix_bits(G_labels[G_side[*q]] * n + H_labels[H_side[*q]] + 1);
+			}
+
+			out.push_back(pattern);
+		}
+
+		std::sort(out.begin() + first, out.end());
+	}
+
+	return out;
+}
+
+bool PermGroup::intersection_search(int level, const Permutation& x, const Permutation& residue, const PermGroup& G, const PermGroup& H, const IntersectionRefinement& refinement, const std::vector<int>& K_orbit_sizes, Permutation& found)
+{
+	int n = x.size();
+
+	while (level < n - 1 && G.level_size(level) == 1 && residue[level] == level) //nothing to choose at this level
+	{
+		level++;
+	}
+
+	if (level == n - 1)
+	{
+		found = x;
+		return true;
+	}
+
+	//A solution is x * g with g in the stabilizer G_level and residue * g in H_level. Then g fixes each orbit D of G_level, carries each orbit E of H_level onto
+	//the points residue sends into E, and permutes the blocks of G; so it carries the points of a block of G in D and E onto those of a block of G in D that
+	//residue sends into E, for every D and E. Likewise for the blocks of H, with residue inverse. The one-block partition compares the orbits themselves.
+	Permutation identity(n);
+
+	if (block_patterns(refinement.G_blocks, refinement.G_labels[level], refinement.H_labels[level], identity, residue) != refinement.G_patterns[level]
+		|| block_patterns(refinement.H_blocks, refinement.G_labels[level], refinement.H_labels[level], residue.inverse(), identity) != refinement.H_patterns[level])
+	{
+		return false;
+	}
+
+	vector<int> G_orbit = G.level_orbit(level);
+	vector<std::pair<int, int>> candidates; //(image of level, point of G_orbit) for x * u agreeing with some element of H on the base points up to level, by increasing image
+
+	for (int j = 0; j < G_orbit.size(); j++)
+	{
+		if (H.in_level_orbit(level, residue[G_orbit[j]]))
+		{
+			candidates.emplace_back(x[G_orbit[j]], G_orbit[j]);
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end());
+
+	//Only the least element of each coset of K_level is looked for, in the order of base images. It maps the K_level-orbit of level into the candidates, onto
+	//images no smaller than its own, so an image needs K_orbit_sizes[level] - 1 larger candidates after it.
+	for (int c = 0; c + K_orbit_sizes[level] <= candidates.size(); c++)
+	{
+		int point = candidates[c].second;
+		int image = residue[point];
+
+		Permutation u = G.coset_rep(level, point);
+
+		if (intersection_search(level + 1, x * u, H.coset_rep_inverse(level, image) * residue * u, G, H, refinement, K_orbit_sizes, found))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+PermGroup intersect(const PermGroup& G, const PermGroup& H)
+{
+	if (G.n != H.n)
+	{
+		throw InvalidGroupOperation();
+	}
+
+	int n = G.n;
+
+	PermGroup G_copy = G;
+	PermGroup H_copy = H;
+
+	G_copy.change_to_standard_base(); //a conjugate's relabeled chain is carried over rather than rebuilt from the generators
+	H_copy.change_to_standard_base();
+
+	PermGroup::IntersectionRefinement refinement;
+
+	refinement.G_labels = G_copy.level_orbit_labels();
+	refinement.H_labels = H_copy.level_orbit_labels();
+	refinement.G_blocks = { BlockSystem(vector<int>(n, 0)) };
+
+	for (const BlockSystem& B : G_copy.minimal_block_systems(0))
+	{
+		if (B.size() > 1)
+		{
+			refinement.G_blocks.push_back(B);
+		}
+	}
+
+	for (const BlockSystem& B : H_copy.minimal_block_systems(0))
+	{
+		if (B.size() > 1)
+		{
+			refinement.H_blocks.push_back(B);
+		}
+	}
+
+	Permutation identity(n);
+
+	for (int i = 0; i < n - 1; i++)
+	{
+		refinement.G_patterns.push_back(block_patterns(refinement.G_blocks, refinement.G_labels[i], refinement.H_labels[i], identity, identity));
+		refinement.H_patterns.push_back(block_patterns(refinement.H_blocks, refinement.G_labels[i], refinement.H_labels[i], identity, identity));
+	}
+
+	vector<Permutation> K_gens;
+	vector<vector<Permutation>> K_strong_gens(n - 1);
+	vector<int> K_orbit_sizes(std::max(n - 1, 0), 1); //K_orbit_sizes[j] = orbit length of j under the stabilizer of 0, ... , j-1 in the intersection, known for j > i
+
+	for (int i = n - 2; i >= 0; i--) //K_gens generates the intersection of the stabilizers of 0, ... , i in G and H
+	{
+		DisjointSets lower_orbits(n); //orbits of the stabilizer of 0, ... , i in the intersection
+
+		for (int j = 0; j < K_gens.size(); j++)
+		{
+			for (int p = 0; p < n; p++)
+			{
+				lower_orbits.unite(p, K_gens[j][p]);
+			}
+		}
+
+		vector<bool> unreachable(n, false);
+
+		vector<int> orbit_index(n, -1); //orbit of i in the intersection, with transversal[orbit_index[p]] mapping i to p
+		orbit_index[i] = 0;
+
+		vector<Permutation> transversal = { Permutation(n) };
+
+		vector<int> G_orbit = G_copy.level_orbit(i);
+
+		for (int j = 0; j < G_orbit.size(); j++)
+		{
+			int target = G_orbit[j];
+
+			if (orbit_index[target] != -1 || unreachable[lower_orbits.find(target)] || !H_copy.in_level_orbit(i, target))
+			{
+				continue;
+			}
+
+			Permutation u = G_copy.coset_rep(i, target);
+			Permutation found(n);
+
+			if (!PermGroup::intersection_search(i + 1, u, H_copy.coset_rep_inverse(i, target) * u, G_copy, H_copy, refinement, K_orbit_sizes, found))
+			{
+				unreachable[lower_orbits.find(target)] = true; //the stabilizer of 0, ... , i would carry one preimage to the others
+				continue;
+			}
+
+			K_gens.push_back(found);
+
+			for (int k = 0; k < transversal.size(); k++) //extend the orbit of i and its transversal by the new generator
+			{
+				int point = transversal[k][i];
+
+				for (int l = 0; l < K_gens.size(); l++)
+				{
+					int image = K_gens[l][point];
+
+					if (orbit_index[image] == -1)
+					{
+						orbit_index[image] = transversal.size();
+						transversal.push_back(K_gens[l] * transversal[k]);
+					}
+				}
+			}
+		}
+
+		K_strong_gens[i] = transversal;
+		K_orbit_sizes[i] = transversal.size();
+	}
+
+	PermGroup K = K_gens.empty() ? PermGroup(n) : PermGroup(K_gens); //already reduced: each found generator maps i out of the orbit of the ones found before it
+
+	if (n > 1)
+	{
+		K.strong_gens = K_strong_gens;
+		K.index_transversals();
+
+		for (int i = 0; i < n - 1; i++)
+		{
+			K.num_strong_gens += K_strong_gens[i].size();
+		}
+	}
+
+	return K;
+}
+
+static Permutation embed(const Permutation& g, int offset, int n) //acts as g on offset, ... , offset + g.size() - 1 and fixes the other points of 0, ... , n-1
+{
+	vector<int> vals(n);
+
+	for (int i = 0; i < n; i++)
+	{
+		vals[i] = i;
+	}
+
+	for (int i = 0; i < g.size(); i++)
+	{
+		vals[offset + i] = offset + g[i];
+	}
+
+	return Permutation(vals);
+}
+
+static Permutation lift_to_blocks(const Permutation& h, int block_size) //moves block b to block h[b], keeping the position within the block
+{
+	vector<int> vals(h.size() * block_size);
+
+	for (int b = 0; b < h.size(); b++)
+	{
+		for (int j = 0; j < block_size; j++)
+		{
+			vals[b * block_size + j] = h[b] * block_size + j;
+		}
+	}
+
+	return Permutation(vals);
+}
+
+PermGroup direct_product(const PermGroup& G, const PermGroup& H)
+{
+	PermGroup G_copy = G;
+	PermGroup H_copy = H;
+
+	if (!G_copy.has_chain())
+	{
+		G_copy.fast_schreier_sims();
+	}
+
+	if (!H_copy.has_chain())
+	{
+		H_copy.fast_schreier_sims();
+	}
+
+	int n_G = G.n;
+	int n = G.n + H.n;
+
+	vector<Permutation> gens;
+
+	for (int j = 0; j < G.generators.size(); j++)
+	{
+		gens.push_back(embed(G.generators[j], 0, n));
+	}
+
+	for (int j = 0; j < H.generators.size(); j++)
+	{
+		gens.push_back(embed(H.generators[j], n_G, n));
+	}
+
+	PermGroup K(gens, G.storage);
+
+	vector<int> K_base(n);
+
+	for (int i = 0; i < n; i++)
+	{
+		K_base[i] = i < n_G ? G_copy.base_point(i) : n_G + H_copy.base_point(i - n_G);
+	}
+
+	K.set_base(K_base);
+
+	if (K.storage == TransversalStorage::schreier_vectors)
+	{
+		vector<Permutation> S;
+		vector<Permutation> G_S = G_copy.strong_generating_set();
+		vector<Permutation> H_S = H_copy.strong_generating_set();
+
+		for (int j = 0; j < G_S.size(); j++)
+		{
+			S.push_back(embed(G_S[j], 0, n));
+		}
+
+		for (int j = 0; j < H_S.size(); j++)
+		{
+			S.push_back(embed(H_S[j], n_G, n));
+		}
+
+		K.install_schreier_gens(S);
+
+		return K;
+	}
+
+	K.strong_gens.assign(n - 1, { Permutation(n) }); //level n_G - 1 fixes all of G's points, so it stays trivial
+
+	for (int i = 0; i < n_G - 1; i++)
+	{
+		vector<int> orbit = G_copy.level_orbit(i);
+
+		for (int k = 1; k < orbit.size(); k++)
+		{
+			K.strong_gens[i].push_back(embed(G_copy.coset_rep(i, orbit[k]), 0, n));
+		}
+	}
+
+	for (int i = 0; i < H.n - 1; i++)
+	{
+		vector<int> orbit = H_copy.level_orbit(i);
+
+		for (int k = 1; k < orbit.size(); k++)
+		{
+			K.strong_gens[n_G + i].push_back(embed(H_copy.coset_rep(i, orbit[k]), n_G, n));
+		}
+	}
+
+	for (int i = 0; i < n - 1; i++)
+	{
+		K.num_strong_gens += K.strong_gens[i].size() - 1;
+	}
+
+	K.index_transversals();
+
+	return K;
+}
+
+PermGroup wreath_product(const PermGroup& G, const PermGroup& H)
+{
+	PermGroup G_copy = G;
+	PermGroup H_copy = H;
+
+	if (!G_copy.has_chain())
+	{
+		G_copy.fast_schreier_sims();
+	}
+
+	if (!H_copy.has_chain())
+	{
+		H_copy.fast_schreier_sims();
+	}
+
+	int k = G.n;
+	int m = H.n;
+	int n = k * m;
+
+	vector<Permutation> gens;
+
+	DisjointSets H_orbits(m); //G acting in one block of each orbit of H is enough
+
+	for (int j = 0; j < H.generators.size(); j++)
+	{
+		gens.push_back(lift_to_blocks(H.generators[j], k));
+
+		for (int b = 0; b < m; b++)
+		{
+			H_orbits.unite(b, H.generators[j][b]);
+		}
+	}
+
+	for (int b = 0; b < m; b++)
+	{
+		if (H_orbits.find(b) != b)
+		{
+			continue;
+		}
+
+		for (int j = 0; j < G.generators.size(); j++)
+		{
+			gens.push_back(embed(G.generators[j], b * k, n));
+		}
+	}
+
+	PermGroup K(gens, G.storage);
+
+	vector<int> K_base(n); //blocks in the order of H's base, and within each block G's base
+
+	for (int t = 0; t < m; t++)
+	{
+		for (int s = 0; s < k; s++)
+		{
+			K_base[t * k + s] = H_copy.base_point(t) * k + G_copy.base_point(s);
+		}
+	}
+
+	K.set_base(K_base);
+
+	if (K.storage == TransversalStorage::schreier_vectors)
+	{
+		vector<Permutation> S;
+		vector<Permutation> G_S = G_copy.strong_generating_set();
+		vector<Permutation> H_S = H_copy.strong_generating_set();
+
+		for (int b = 0; b < m; b++)
+		{
+			for (int j = 0; j < G_S.size(); j++)
+			{
+				S.push_back(embed(G_S[j], b * k, n));
+			}
+		}
+
+		for (int j = 0; j < H_S.size(); j++)
+		{
+			S.push_back(lift_to_blocks(H_S[j], k));
+		}
+
+		K.install_schreier_gens(S);
+
+		return K;
+	}
+
+	K.strong_gens.resize(n - 1);
+
+	for (int t = 0; t < m; t++)
+	{
+		int block = H_copy.base_point(t);
+
+		//the stabilizer of the earlier blocks permutes the remaining ones through H's level t; once a point of the block is fixed, only G's levels act on it
+		vector<int> H_orbit = t < m - 1 ? H_copy.level_orbit(t) : vector<int>{ block };
+
+		for (int s = 0; s < k && t * k + s < n - 1; s++)
+		{
+			vector<int> G_orbit = s < k - 1 ? G_copy.level_orbit(s) : vector<int>{ G_copy.base_point(s) };
+			vector<int> blocks = s == 0 ? H_orbit : vector<int>{ block };
+
+			vector<Permutation>& level = K.strong_gens[t * k + s];
+
+			for (int c = 0; c < blocks.size(); c++)
+			{
+				Permutation u = c == 0 ? Permutation(n) : lift_to_blocks(H_copy.coset_rep(t, blocks[c]), k);
+
+				for (int x = 0; x < G_orbit.size(); x++)
+				{
+					level.push_back(x == 0 ? u : embed(G_copy.coset_rep(s, G_orbit[x]), blocks[c] * k, n) * u);
+				}
+			}
+
+			K.num_strong_gens += level.size() - 1;
+		}
+	}
+
+	K.index_transversals();
+
+	return K;
 }
@@ -3,9 +3,32 @@
 #include <set>
 #include <vector>
 #include "Permutation.h"
+#include "ComputationControl.h"
+
+#include "GraphLibrary/DisjointSets.h"
+
+enum class TransversalStorage
+{
+	explicit_transversals, //every coset representative stored as a Permutation; O(1) lookup, O(n^2) memory per transitive level
+	schreier_vectors //one int per point and level, representatives rebuilt from shallow Schreier trees on demand
+};
+
+struct GiantHomomorphism //homomorphism from a group onto Alt(k) or Sym(k), given by its action on k blocks
+{
+	BlockSystem blocks;
+	bool alternating; //true if the image is Alt(k) rather than Sym(k)
+
+	Permutation operator()(const Permutation& g) const; //image of g in Sym(k)
+};
 
 class PermGroup
 {
+	friend class CosetTable;
+	friend class FrozenPermGroup;
+	friend PermGroup intersect(const PermGroup& G, const PermGroup& H);
+	friend PermGroup direct_product(const PermGroup& G, const PermGroup& H);
+	friend PermGroup wreath_product(const PermGroup& G, const PermGroup& H);
+
 private:
 
 	int n; //subgroup of S_n
@@ -13,25 +36,99 @@ private:
 
 	std::vector<Permutation> generators;
 
-	std::vector<std::vector<Permutation>> strong_gens; //to be created by call to schreier_sims; 
+	TransversalStorage storage;
+
+	std::vector<int> base; //base[i] = the point whose orbit level i stores, an ordering of 0, ... , n-1; empty for the standard base 0, 1, ... , n-1
+
+	std::vector<std::vector<Permutation>> strong_gens; //to be created by call to schreier_sims; explicit_transversals only
+	std::vector<std::vector<int>> transversal_index; //transversal_index[i][p] = index in strong_gens[i] of the coset rep mapping i to p, or -1
+
+	std::vector<Permutation> schreier_gens; //schreier_vectors only: strong generators, shortcut generators and their inverses
+	std::vector<Permutation> schreier_gen_inverses;
+	std::vector<bool> shortcut; //shortcut[j] = schreier_gens[j] was only added to make a tree shallow, so it yields no new Schreier generators
+	std::vector<std::vector<int>> level_gens; //level_gens[i] = indices into schreier_gens of generators of the stabilizer of 0, ... , i-1
+	std::vector<std::vector<int>> schreier_vectors; //schreier_vectors[i][p] = index into schreier_gens labelling the tree edge into p, -2 at the root i, -1 off the orbit; empty while the orbit of i is {i}
+	std::vector<std::vector<int>> level_orbits;
+
+	std::vector<Permutation> random_state; //product replacement state for random_element, accumulator last; cleared when the generators change
 
 	PermGroup(const std::vector<std::vector<Permutation>>& strong_generators); //constructs a group given its strong generators
 
 	void schreier_sims();
 	void fast_schreier_sims();
+	ComputationStatus extend_strong_gens(std::set<Permutation> gens, ComputationControl* control = nullptr); //sifts gens into the current strong generating set, closing it under products of coset representatives; only a control can stop it early
+	ComputationStatus block_stabilizer_closure(const BlockSystem& B, std::vector<std::vector<Permutation>>& H_strong_gens, std::set<Permutation>& gens, ComputationControl* control);
+	PermGroup block_stabilizer_result(const BlockSystem& B, const std::vector<std::vector<Permutation>>& H_strong_gens) const;
+
+	void write_checkpoint(const std::string& path, const std::string& kind, const std::vector<int>& key, const std::vector<std::vector<Permutation>>& levels, const std::set<Permutation>& pending) const; //writes to path.tmp, then renames, so a crash never leaves a torn checkpoint
+	void read_checkpoint(const std::string& path, const std::string& kind, const std::vector<int>& key, std::vector<std::vector<Permutation>>& levels, std::set<Permutation>& pending) const; //throws InvalidGroupOperation unless path holds a checkpoint of the same computation (kind and key) on these generators
+
+	void reset_strong_gens(); //explicit_transversals: identity coset rep at every level
+	void add_coset_rep(int i, const Permutation& gamma); //explicit_transversals: appends gamma to strong_gens[i] and indexes it
+	void index_transversals(); //explicit_transversals: rebuilds transversal_index from strong_gens
+
+	int base_point(int i) const { return base.empty() ? i : base[i]; }
+	void set_base(const std::vector<int>& new_base); //stores new_base, kept empty if it is the standard ordering; does not touch the chain
+	void use_standard_base(); //drops a relabeled base together with the chain built on it
+	void change_to_standard_base(); //keeps a chain on the standard base; otherwise builds a schreier_vectors one, carrying a relabeled chain over by sifting uniformly random elements drawn from it until the orders agree
+	std::vector<Permutation> strong_generating_set() const; //generates every level's stabilizer; the chain must exist
+	void install_schreier_gens(const std::vector<Permutation>& S); //schreier_vectors: new chain with S as level generators and fresh Schreier trees; no sifting
+
+	void schreier_vector_sims(int start_level); //schreier_vectors: Schreier-Sims from start_level up to level 0, assuming the levels below start_level are complete
+	void add_schreier_gen(const Permutation& g, int first_level, int last_level, bool is_shortcut = false); //schreier_vectors: adds g to the generators of levels first_level, ... , last_level
+	void build_schreier_tree(int i); //BFS tree for level i, adding shortcut generators until its depth is at most 2 log2(orbit length) + 1
+
+	bool has_chain() const;
+	int level_size(int i) const; //length of the orbit of base point i under the stabilizer of base points 0, ... , i-1
+	std::vector<int> level_orbit(int i) const; //starts with the base point
+	bool in_level_orbit(int i, int p) const;
+	Permutation coset_rep(int i, int p) const; //element of the stabilizer of base points 0, ... , i-1 mapping base point i to p; p must be in level_orbit(i)
+	Permutation coset_rep_inverse(int i, int p) const;
+	std::vector<std::vector<int>> level_orbit_labels() const; //[i][p] = label of the orbit of p under the stabilizer of base points 0, ... , i-1
+
+	struct IntersectionRefinement //what every element of both G and H must respect; set up once by intersect
+	{
+		std::vector<std::vector<int>> G_labels; //level_orbit_labels of G and of H
+		std::vector<std::vector<int>> H_labels;
+		std::vector<BlockSystem> G_blocks; //the one-block partition, then the block systems of G through point 0
+		std::vector<BlockSystem> H_blocks; //the block systems of H through point 0
+		std::vector<std::vector<unsigned long long>> G_patterns; //G_patterns[i] = the block patterns of G_blocks at level i for the identity residue
+		std::vector<std::vector<unsigned long long>> H_patterns;
+	};
+
+	static bool intersection_search(int level, const Permutation& x, const Permutation& residue, const PermGroup& G, const PermGroup& H, const IntersectionRefinement& refinement, const std::vector<int>& K_orbit_sizes, Permutation& found); //x is in G, residue is x sifted through the levels of H before level; K_orbit_sizes prunes to the least element of each coset of the intersection found so far
 
-	std::pair<int, Permutation> filter(const Permutation& g);
-	std::pair<int, Permutation> block_filter(const Permutation& g, const std::vector<std::vector<Permutation>>& H_strong_gens, const std::vector<std::set<int>>& B);
+	std::pair<int, Permutation> filter(const Permutation& g, int start_level = 0) const;
+	std::pair<int, Permutation> block_filter(const Permutation& g, const std::vector<std::vector<Permutation>>& H_strong_gens, const BlockSystem& B);
+
+	void merge_blocks(DisjointSets& classes, const std::vector<std::pair<int, int>>& pairs); //unites each given pair, then keeps merging until the classes form a G-invariant partition (Atkinson)
 
-	//bool fixes_blocks(const Permutation& g, const std::vector<std::set<int>>& B); //B is a G-block system; returns whether g fixes all blocks in B or not
  
 public:
 
-	PermGroup(const std::vector<Permutation>& gens); 
+	PermGroup(const std::vector<Permutation>& gens, TransversalStorage storage = TransversalStorage::explicit_transversals); 
 	PermGroup(int size); //returns trivial group of identity permutation on n elements  
 
+	int degree() const { return n; }
+	const std::vector<Permutation>& get_generators() const { return generators; }
+
+	TransversalStorage get_storage() const { return storage; }
+	void set_storage(TransversalStorage new_storage); //discards the chain if the storage changes; it is rebuilt on the next query
+
+	PermGroup conjugate(const Permutation& pi); //returns pi G pi^-1; the chain is relabeled rather than recomputed, so the result's base is pi applied to this one's
+
+	void reduce_generators(bool complete = true); //keeps only generators which enlarge the group generated by those kept before them; since each kept one strictly enlarges it, at most log2 |G| (and 3n/2) remain
+	//complete = false tests each generator against a chain of the kept ones that skips Schreier-Sims: far cheaper on large groups, same group, but a generator the kept ones already generate may be kept too
+	void add_generator(const Permutation& g); //replaces the group by <G, g>; an existing strong generating set is extended rather than recomputed
+
+	ComputationStatus build_chain(ComputationControl& control); //explicit_transversals only: Schreier-Sims under control; after an early stop the partial chain is dropped, and resume_chain continues from control.checkpoint_path
+	ComputationStatus resume_chain(ComputationControl& control); //throws InvalidGroupOperation, leaving the group as it was, unless the checkpoint is complete, of this computation, and a valid chain
+
 	bool contains(const Permutation& g); //returns true if group contains g, false otherwise; uses strong generating set
 
+	Permutation min_coset_rep(const Permutation& g); //lexicographically smallest element of gH, H this group; one pass down the chain, O(n) per level
+	std::vector<int> min_image(const std::vector<int>& v); //lexicographically smallest (v[g[0]], v[g[1]], ... , v[g[n-1]]) over g in G; one pass when the entries of v are distinct, branching only on repeated values
+
 	std::vector<Permutation> factor(const Permutation& g); // returns {} if group does not contain g, returns factorization in canonical form otherwise (factors given in order) 
 
 	unsigned long long int order();
@@ -40,6 +137,8 @@ public:
 	void print_strong_gens(); 
 	void print_generators();
 
+	bool in_orbit(int a, int b) const; //true if some element of G maps a to b; explores the orbit of a only until b turns up (see OrbitStream)
+
 	std::vector<std::set<int>> compute_orbits(std::set<int> s); // assumes s is a subset of {0,1, ... n-1}; copies s for use in algorithm
 
 	//std::set<int> get_orbit(int a); //returns orbit of a 
@@ -95,12 +194,36 @@ public:
 	}
 
 
-	std::vector<std::set<int>> minimal_block_system(const std::set<int>& s); //s is a subset of {0,1, ... n-1}
-	std::vector<std::set<int>> minimal_block_system(const std::vector<std::set<int>>& B); // B is a G-block system
+	BlockSystem minimal_block_system(const std::set<int>& s); //s is a subset of {0,1, ... n-1}
+	BlockSystem minimal_block_system(const BlockSystem& B); // B is a G-block system
+	BlockSystem minimal_block_system(int a, int b); //finest G-invariant partition of {0,1, ... n-1} with a and b in the same block
+	std::vector<BlockSystem> minimal_block_systems(int a); //all distinct minimal_block_system(a, b) for b != a
+
+	bool is_transitive(); //true on 0 points
+	bool is_primitive(); //transitive and admits no block system besides the trivial ones
 
-	PermGroup block_stabilizer(const std::vector<std::set<int>>& B); // B is a G-block system; returns the subgroup of G which fixes all blocks; finds strong generators 
+	PermGroup block_stabilizer(const BlockSystem& B); // B is a G-block system; returns the subgroup of G which fixes all blocks; finds strong generators 
+	std::pair<ComputationStatus, PermGroup> block_stabilizer(const BlockSystem& B, ComputationControl& control); //block_stabilizer(B) under control; after an early stop .second is the trivial group
+	std::pair<ComputationStatus, PermGroup> resume_block_stabilizer(const BlockSystem& B, ComputationControl& control); //continues from control.checkpoint_path; throws InvalidGroupOperation on a truncated, corrupt or foreign checkpoint
+
+	bool is_trivial() const; //true if every generator is the identity
+
+	PermGroup normal_closure(const std::vector<Permutation>& S); //returns the smallest normal subgroup of G containing S
+	PermGroup derived_subgroup(); //returns [G,G]
+	std::vector<PermGroup> derived_series(); //G = G^(0) > G^(1) > ... ; ends at the trivial group if G is solvable, or at the perfect group G^(k) = G^(k+1) otherwise
+	bool is_solvable();
+
+	Permutation random_element(RandomNumberEngine& rand_eng); //product replacement ("rattle"); close to uniform once the state has been scrambled
+	bool is_giant(RandomNumberEngine& rand_eng, double error = 1e-6); //true if G contains Alt(n); one-sided Monte Carlo: true is always right, false is wrong with probability at most error
+	std::pair<bool, GiantHomomorphism> giant_homomorphism(const BlockSystem& B, RandomNumberEngine& rand_eng, double error = 1e-6); //B is a G-block system; tests whether G acts on the blocks as Alt or Sym, and if so returns that action
 };
 
+PermGroup intersect(const PermGroup& G, const PermGroup& H); //returns G and H intersected, with its strong generating set already built; backtracks over the common base 0,1, ... n-1, keeping images allowed by both chains, dropping a branch once no element of it can carry the blocks of G and of H onto blocks meeting the stabilizer orbits of both in the same numbers, and pruning by the orbits of the intersection found so far
+
+//the products below assemble their chains from the factors' chains, in time linear in the result's chain; the result uses G's storage
+PermGroup direct_product(const PermGroup& G, const PermGroup& H); //G x H, with G on 0, ... , G.degree()-1 and H on the points after
+PermGroup wreath_product(const PermGroup& G, const PermGroup& H); //G wr H: H permutes H.degree() blocks of G.degree() points each, point j of block b being b * G.degree() + j
+
 std::vector<Permutation> operator*(Permutation const& s, std::vector<Permutation> const& set); //returns set*s
 std::vector<Permutation> operator*(const std::vector<Permutation>& set, Permutation const& s); // returns s*set
 
@@ -115,6 +238,16 @@ public:
 	}
 };
 
+class InvalidGroupOperation : public std::exception
+{
+public:
+
+	virtual char const* what() const throw()
+	{
+		return "Attempted invalid group operation";
+	}
+};
+
 
 struct Coset
 {
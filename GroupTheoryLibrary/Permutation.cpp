@@ -1,7 +1,9 @@
 #include "Permutation.h"
 
 #include <set>
+#include <algorithm>
 #include <iostream>
+#include <utility>
 
 using std::cout;
 using std::endl;
@@ -9,32 +11,32 @@ using std::set;
 using std::vector;
 
 Permutation::Permutation(std::vector<int> vals) :
-	values(vals),
-	sz(vals.size())
+	sz(vals.size()),
+	values(std::move(vals)) //taken by value, so callers can move their array in
 {
-	std::set<int> repeats = {};
+	std::vector<bool> repeats(sz, false); //products and inverses are validated here too, so keep this linear
 
-	for (int i = 0; i < vals.size(); i++)
+	for (int i = 0; i < sz; i++)
 	{
-		if (vals[i] < 0 || vals[i] >= sz || repeats.count(vals[i]))
+		if (values[i] < 0 || values[i] >= sz || repeats[values[i]])
 		{
 			throw InvalidPermutation();
 		}
 
 		else
 		{
-			repeats.insert(vals[i]);
+			repeats[values[i]] = true;
 		}
 	}
 }
 
 Permutation::Permutation(int n) :
-	values({}),
-	sz(n)
+	sz(n),
+	values(std::max(n, 0))
 {
 	for (int i = 0; i < n; i++)
 	{
-		values.push_back(i);
+		values[i] = i;
 	}
 }
 
@@ -98,7 +100,7 @@ Permutation operator*(Permutation const& s, Permutation const& t)
 		c_vals[i] = s[t[i]];
 	}
 
-	return Permutation(c_vals);
+	return Permutation(std::move(c_vals));
 }
 
 std::vector<Permutation> operator*(Permutation const& s, std::vector<Permutation> const& set)
@@ -161,18 +163,56 @@ Graph Permutation::operator[](const Graph& G) const
 		throw InvalidPermOperation();
 	}
 
-	std::vector<std::set<int>> G_adj = G.get_adj();
+	const std::vector<std::set<int>>& G_adj = G.adj_list();
+
+	std::vector<std::pair<int, int>> edge_list;
 
-	Graph out(G.size());
+	edge_list.reserve(G.edges());
 
 	for (int i = 0; i < G.size(); i++)
 	{
-		for (auto j = G_adj[i].begin(); j != G_adj[i].end(); j++)
+		for (auto j = G_adj[i].upper_bound(i); j != G_adj[i].end(); j++)
 		{
-			out.insert_edge(values[i], values[*j]);
+			edge_list.emplace_back(values[i], values[*j]);
 		}
 	}
-	return out; 
+
+	return Graph(G.size(), edge_list);
+}
+
+CSRGraph Permutation::operator[](const CSRGraph& G) const
+{
+	if (G.size() != sz)
+	{
+		throw InvalidPermOperation();
+	}
+
+	vector<int> offsets(sz + 1, 0); //vertex values[i] takes over the degree of i
+	vector<int> neighbors(G.neighbor_array().size());
+
+	for (int i = 0; i < sz; i++)
+	{
+		offsets[values[i] + 1] = G.degree(i);
+	}
+
+	for (int i = 0; i < sz; i++)
+	{
+		offsets[i + 1] += offsets[i];
+	}
+
+	for (int i = 0; i < sz; i++)
+	{
+		int* out = neighbors.data() + offsets[values[i]];
+
+		for (const int* j = G.begin(i); j != G.end(i); j++)
+		{
+			*out++ = values[*j];
+		}
+
+		std::sort(neighbors.data() + offsets[values[i]], out);
+	}
+
+	return CSRGraph(std::move(offsets), std::move(neighbors));
 }
 
 Permutation Permutation::inverse() const
@@ -184,7 +224,7 @@ Permutation Permutation::inverse() const
 		i_vals[values[i]] = i;
 	}
 
-	return Permutation(i_vals);
+	return Permutation(std::move(i_vals));
 }
 
 void Permutation::print() const
@@ -226,6 +266,37 @@ void Permutation::print_cycles() const
 	}
 }
 
+std::vector<int> Permutation::cycle_lengths() const
+{
+	vector<bool> visited(sz, false);
+	vector<int> out;
+
+	for (int i = 0; i < sz; i++)
+	{
+		if (visited[i])
+		{
+			continue;
+		}
+
+		int length = 0;
+
+		for (int j = i; !visited[j]; j = values[j])
+		{
+			visited[j] = true;
+			length++;
+		}
+
+		out.push_back(length);
+	}
+
+	return out;
+}
+
+bool Permutation::is_even() const
+{
+	return (sz - cycle_lengths().size()) % 2 == 0; //a k-cycle is a product of k-1 transpositions
+}
+
 Permutation Permutation::rand_perm(int n,RandomNumberEngine& rand_eng)
 {
 	vector<int> vals = {};
@@ -248,11 +319,16 @@ Permutation Permutation::rand_perm(int n,RandomNumberEngine& rand_eng)
 	return Permutation(vals);
 }
 
-bool Permutation::fixes_blocks(const std::vector<std::set<int>>& B)
+bool Permutation::fixes_blocks(const BlockSystem& B) const
 {
-	for (int i = 0; i < B.size(); i++)
+	if (B.degree() != sz)
+	{
+		throw InvalidPermOperation();
+	}
+
+	for (int p = 0; p < sz; p++)
 	{
-		if ((*this)[B[i]] != B[i])
+		if (B.block(p) != -1 && B.block(values[p]) != B.block(p))
 		{
 			return false;
 		}
@@ -7,6 +7,9 @@
 #include "RandomNumberEngine/RandomNumberEngine.h"
 
 #include "GraphLibrary/Graph.h"
+#include "GraphLibrary/CSRGraph.h"
+
+#include "BlockSystem.h"
 
 class Permutation
 {
@@ -53,6 +56,7 @@ public:
 	}
 
 	Graph operator[](const Graph& G) const; //returns image of graph
+	CSRGraph operator[](const CSRGraph& G) const; //returns image of graph, built directly in CSR form
 
 	 int size() const { return sz; }
 	
@@ -61,9 +65,12 @@ public:
 	void print() const;
 	void print_cycles() const; //prints cycle decomposition of permutation
 
+	std::vector<int> cycle_lengths() const; //lengths of the cycles, fixed points included, in order of their smallest element
+	bool is_even() const;
+
 	static Permutation rand_perm(int n, RandomNumberEngine& rand_eng) ; //returns a u.a.r selected permutation of size n, assuming rand returns a uniform integer
 
-	bool fixes_blocks(const std::vector<std::set<int>>& B); //returns true if perm fixes each set in B
+	bool fixes_blocks(const BlockSystem& B) const; //returns true if perm maps each block of B onto itself
 };
 
 Permutation operator*(Permutation const& s, Permutation const& t); //returns composition st
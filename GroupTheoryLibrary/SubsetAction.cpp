@@ -0,0 +1,181 @@
+#include "SubsetAction.h"
+
+#include <algorithm>
+#include <climits>
+
+using std::vector;
+
+SubsetAction::SubsetAction(int n, int k) :
+	n(n),
+	k(k),
+	ordered(false)
+{
+	if (k < 0 || k > n)
+	{
+		throw InvalidGroupOperation();
+	}
+
+	const long long saturated = (long long)INT_MAX + 1; //larger than every rank, so ranking and unranking never read past it
+
+	binomial.assign(n + 1, vector<long long>(k + 1, 0));
+
+	for (int i = 0; i <= n; i++)
+	{
+		binomial[i][0] = 1;
+
+		for (int j = 1; j <= k && j <= i; j++)
+		{
+			binomial[i][j] = std::min(saturated, binomial[i - 1][j - 1] + (j <= i - 1 ? binomial[i - 1][j] : 0));
+		}
+	}
+
+	if (binomial[n][k] == saturated)
+	{
+		throw InvalidGroupOperation();
+	}
+
+	num_points = binomial[n][k];
+}
+
+SubsetAction::SubsetAction(int n) :
+	n(n),
+	k(2),
+	ordered(true),
+	binomial({})
+{
+	if ((long long)n * (n - 1) > INT_MAX)
+	{
+		throw InvalidGroupOperation();
+	}
+
+	num_points = n * (n - 1);
+}
+
+SubsetAction SubsetAction::ordered_pairs(int n)
+{
+	return SubsetAction(n);
+}
+
+int SubsetAction::rank(const int* subset) const
+{
+	if (ordered)
+	{
+		return subset[0] * (n - 1) + (subset[1] < subset[0] ? subset[1] : subset[1] - 1);
+	}
+
+	long long r = 0;
+
+	for (int i = 0; i < k; i++)
+	{
+		r += binomial[subset[i]][i + 1];
+	}
+
+	return r;
+}
+
+void SubsetAction::unrank(int r, int* subset) const
+{
+	if (ordered)
+	{
+		subset[0] = r / (n - 1);
+		subset[1] = r % (n - 1);
+
+		if (subset[1] >= subset[0])
+		{
+			subset[1]++;
+		}
+
+		return;
+	}
+
+	int c = n - 1;
+
+	for (int i = k; i >= 1; i--) //the largest entry c is the largest with (c choose i) <= r
+	{
+		while (binomial[c][i] > r)
+		{
+			c--;
+		}
+
+		subset[i - 1] = c;
+		r -= binomial[c][i];
+		c--;
+	}
+}
+
+int SubsetAction::rank(const std::set<int>& s) const
+{
+	vector<int> entries(s.begin(), s.end());
+
+	return rank(entries.data());
+}
+
+std::set<int> SubsetAction::subset(int r) const
+{
+	vector<int> entries(k);
+
+	unrank(r, entries.data());
+
+	return std::set<int>(entries.begin(), entries.end());
+}
+
+int SubsetAction::image(const Permutation& g, int r, int* buffer) const
+{
+	unrank(r, buffer);
+
+	for (int i = 0; i < k; i++)
+	{
+		buffer[i] = g[buffer[i]];
+	}
+
+	if (!ordered)
+	{
+		for (int i = 1; i < k; i++) //insertion sort; k is small
+		{
+			int entry = buffer[i];
+			int j = i - 1;
+
+			while (j >= 0 && buffer[j] > entry)
+			{
+				buffer[j + 1] = buffer[j];
+				j--;
+			}
+
+			buffer[j + 1] = entry;
+		}
+	}
+
+	return rank(buffer);
+}
+
+Permutation SubsetAction::induced(const Permutation& g) const
+{
+	if (g.size() != n)
+	{
+		throw InvalidPermOperation();
+	}
+
+	vector<int> buffer(k);
+	vector<int> values(num_points);
+
+	for (int r = 0; r < num_points; r++)
+	{
+		values[r] = image(g, r, buffer.data());
+	}
+
+	return Permutation(values);
+}
+
+PermGroup SubsetAction::induced_group(const PermGroup& G) const
+{
+	const vector<Permutation>& gens = G.get_generators();
+
+	vector<Permutation> induced_gens;
+
+	for (int i = 0; i < gens.size(); i++)
+	{
+		induced_gens.push_back(induced(gens[i]));
+	}
+
+	return PermGroup(induced_gens);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <set>
+
+#include "Permutation.h"
+#include "PermGroup.h"
+
+class SubsetAction //numbers the k-subsets (or ordered pairs) of {0, ... , n-1} as points 0, ... , points()-1 so that permutations of {0, ... , n-1} act on them as integers
+{
+
+private:
+
+	int n;
+	int k;
+
+	bool ordered; //true if the points are ordered pairs (a, b) with a != b rather than k-subsets
+
+	int num_points;
+
+	std::vector<std::vector<long long>> binomial; //binomial[i][j] = i choose j, for i <= n and j <= k, capped at INT_MAX + 1
+
+	SubsetAction(int n); //ordered pairs
+
+public:
+
+	SubsetAction(int n, int k); //k-subsets, ranked in the combinatorial number system; throws InvalidGroupOperation if k is not in 0, ... , n or there are more than INT_MAX of them
+
+	static SubsetAction ordered_pairs(int n); //ordered pairs (a, b), ranked as a*(n-1) + (b < a ? b : b-1)
+
+	int points() const { return num_points; }
+	int subset_size() const { return k; }
+
+	int rank(const int* subset) const; //subset holds k entries, in increasing order for k-subsets
+	void unrank(int r, int* subset) const; //writes the subset of rank r into subset[0], ... , subset[k-1]
+
+	int rank(const std::set<int>& s) const;
+	std::set<int> subset(int r) const;
+
+	int image(const Permutation& g, int r, int* buffer) const; //rank of g applied to subset r; buffer must hold k ints, so nothing is allocated
+	Permutation induced(const Permutation& g) const; //the permutation of {0, ... , points()-1} induced by g
+
+	PermGroup induced_group(const PermGroup& G) const; //G acting on the ranks
+};
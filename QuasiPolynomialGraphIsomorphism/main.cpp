@@ -7,6 +7,7 @@
 
 #include "RandomNumberEngine/RandomNumberEngine.h"
 #include "GraphLibrary/Graph.h"
+#include "GraphLibrary/CSRGraph.h"
 #include "GraphLibrary/DecomposedGraph.h"
 
 using std::cout;
@@ -22,12 +23,7 @@ int main()
 	RandomNumberEngine engine;
 
 	
-	Graph g = Graph::gnp_random(1000, 0.01f, engine);
-
-	while (!g.is_connected())
-	{
-		g = Graph::gnp_random(1000, 0.01f, engine);
-	}
+	Graph g = CSRGraph::gnp_random_connected(1000, 0.01, engine.random_int(1, 2147483646)).to_graph();
 
 	g.print();
 
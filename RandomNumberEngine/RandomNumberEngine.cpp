@@ -32,6 +32,11 @@ float RandomNumberEngine::random_float()
 	return static_cast<float>(rand()) / static_cast<float>(rand.max());
 }
 
+double RandomNumberEngine::random_double()
+{
+	return std::generate_canonical<double, 53>(rand);
+}
+
 float RandomNumberEngine::random_float(float l, float u)
 {
 	if (l > u)
@@ -23,6 +23,8 @@ public:
 	float random_float(); //returns uniform float in [0,1]
 	float random_float(float l, float u); //uniform random float in range [l,u]
 
+	double random_double(); //uniform double in [0,1), with 53 random bits
+
 
 };
 